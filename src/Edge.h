@@ -67,4 +67,41 @@ private:
 	WeightType w;
 };
 
+/*! A plain (src id, weight, dst id) record. Batches of these are what the bulk loading path
+(add_edges) takes, so loading an edge does not require an Edge object. */
+template <typename IdType, typename WeightType>
+struct EdgeRecord{
+	IdType src;
+	WeightType weight;
+	IdType dst;
+};
+
+/*! A light edge, as edge_refs and edge_refs_of_node return them: src and dst are handles to the
+Nodes held by the graph, so an EdgeRef is trivially copyable and making one touches no reference
+count. It reads like an Edge, and to_edge makes the Edge when one is needed. An EdgeRef is valid
+while its nodes stay in the graph. */
+template <typename IdType, typename WeightType, typename DataType>
+struct EdgeRef{
+	const shared_ptr<Node<IdType, DataType>> * src_p;
+	const shared_ptr<Node<IdType, DataType>> * dst_p;
+	WeightType weight;
+
+	inline const shared_ptr<Node<IdType, DataType>>& get_src() const {
+		return *src_p;
+	}
+
+	inline const shared_ptr<Node<IdType, DataType>>& get_dst() const {
+		return *dst_p;
+	}
+
+	inline WeightType get_weight() const {
+		return weight;
+	}
+
+	/*! Makes the Edge object for this edge */
+	inline shared_ptr<Edge<IdType, WeightType, DataType>> to_edge() const {
+		return Edge<IdType, WeightType, DataType>::create_edge(*src_p, weight, *dst_p);
+	}
+};
+
 #endif
\ No newline at end of file
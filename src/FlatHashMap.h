@@ -0,0 +1,187 @@
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#define FLAT_FIRST_ALLOC 16
+#define FLAT_MAX_LOAD 0.75
+
+#include <vector>
+#include <utility>
+#include <functional>
+#include <stdint.h>
+
+
+/*! Customization point for hashing the ids of Nodes. The graphs hash IdType through this
+struct, which defaults to std::hash. Specialize it for an IdType that std::hash does not cover,
+or when a better hash for the ids is known. */
+template <typename IdType>
+struct id_hash{
+	inline size_t operator()(const IdType& id) const {
+		return std::hash<IdType>()(id);
+	}
+};
+
+/* Spreads the bits of a hash over the whole word (the splitmix64 finalizer), so that sums of
+mixed hashes do not cancel out */
+inline uint64_t mix_hash(uint64_t h){
+	h ^= h >> 30;
+	h *= 0xbf58476d1ce4e5b9ull;
+	h ^= h >> 27;
+	h *= 0x94d049bb133111ebull;
+	return h ^ (h >> 31);
+}
+
+/*! The share of a node in the fingerprint of a graph. The fingerprint is the sum of the shares of
+all the nodes and edges, modulo 2^64, so it does not depend on the order they were added in and a
+removal takes its share back out */
+template <typename IdType>
+inline uint64_t node_fingerprint(const IdType& id){
+	return mix_hash(id_hash<IdType>()(id));
+}
+
+/*! The share of an edge in the fingerprint of a graph, see node_fingerprint. It depends on the
+direction of the edge and on its weight */
+template <typename IdType, typename WeightType>
+inline uint64_t edge_fingerprint(const IdType& src, const WeightType& w, const IdType& dst){
+	uint64_t h = mix_hash(id_hash<IdType>()(src) + 0x9E3779B97F4A7C15ull);
+	h = mix_hash(h ^ id_hash<IdType>()(dst));
+	return mix_hash(h ^ std::hash<WeightType>()(w));
+}
+
+
+/*! This is a supporting class for the graph implementations. It is a flat open addressing
+hash map with linear probing: all the entries live in one array, so a lookup is a hash and
+usually a single cache miss. Erasing shifts the following entries back instead of leaving
+tombstones, so the probe sequences stay short under churn. */
+template <typename Key, typename Value, typename Hash = id_hash<Key>>
+class FlatHashMap{
+
+public:
+
+	FlatHashMap(){
+		count = 0;
+		allocate(FLAT_FIRST_ALLOC);
+	}
+
+	/*! Returns a pointer to the value stored under key, or nullptr if there is none */
+	inline Value * find(const Key& key){
+		size_t i = home_of(key);
+		while(full[i]){
+			if(slots[i].first == key)
+				return &slots[i].second;
+			i = (i + 1) & mask;
+		}
+		return nullptr;
+	}
+
+	inline const Value * find(const Key& key) const {
+		return const_cast<FlatHashMap *>(this)->find(key);
+	}
+
+	/*! Returns the value stored under key, inserting a default constructed one if there is none */
+	inline Value& operator[](const Key& key){
+		if(count + 1 > slots.size() * FLAT_MAX_LOAD)
+			rehash(slots.size() * 2);
+
+		size_t i = home_of(key);
+		while(full[i]){
+			if(slots[i].first == key)
+				return slots[i].second;
+			i = (i + 1) & mask;
+		}
+
+		full[i] = true;
+		slots[i].first = key;
+		slots[i].second = Value();
+		count++;
+		return slots[i].second;
+	}
+
+	/*! Removes the entry of key. Returns the number of removed entries */
+	size_t erase(const Key& key){
+		size_t i = home_of(key);
+		while(full[i] && !(slots[i].first == key)){
+			i = (i + 1) & mask;
+		}
+		if(!full[i])
+			return 0;
+
+		/* Shift back every following entry of the cluster that is allowed to move into the hole */
+		size_t hole = i;
+		size_t j = i;
+		while(true){
+			j = (j + 1) & mask;
+			if(!full[j])
+				break;
+			size_t home = home_of(slots[j].first);
+			if(((j - home) & mask) >= ((j - hole) & mask)){
+				slots[hole] = std::move(slots[j]);
+				hole = j;
+			}
+		}
+		full[hole] = false;
+		slots[hole] = std::pair<Key, Value>();
+		count--;
+		return 1;
+	}
+
+	/*! Makes room for n entries without rehashing */
+	void reserve(size_t n){
+		size_t capacity = slots.size();
+		while(n > capacity * FLAT_MAX_LOAD)
+			capacity *= 2;
+		if(capacity != slots.size())
+			rehash(capacity);
+	}
+
+	inline size_t size() const {
+		return count;
+	}
+
+	inline bool empty() const {
+		return count == 0;
+	}
+
+	void clear(){
+		count = 0;
+		allocate(FLAT_FIRST_ALLOC);
+	}
+
+private:
+	std::vector<std::pair<Key, Value>> slots;
+	std::vector<char> full;
+	size_t mask;
+	size_t count;
+
+	/* Fibonacci hashing spreads identity hashes, such as the one of std::hash<int>,
+	over the whole table */
+	inline size_t home_of(const Key& key) const {
+		uint64_t h = Hash()(key) * 0x9E3779B97F4A7C15ull;
+		return (h ^ (h >> 32)) & mask;
+	}
+
+	void allocate(size_t capacity){
+		slots.assign(capacity, std::pair<Key, Value>());
+		full.assign(capacity, false);
+		mask = capacity - 1;
+	}
+
+	void rehash(size_t capacity){
+		std::vector<std::pair<Key, Value>> old_slots;
+		std::vector<char> old_full;
+		old_slots.swap(slots);
+		old_full.swap(full);
+
+		allocate(capacity);
+		for(size_t k = 0; k < old_slots.size(); ++k){
+			if(!old_full[k]) continue;
+			size_t i = home_of(old_slots[k].first);
+			while(full[i]){
+				i = (i + 1) & mask;
+			}
+			full[i] = true;
+			slots[i] = std::move(old_slots[k]);
+		}
+	}
+
+};
+#endif
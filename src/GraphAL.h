@@ -9,9 +9,20 @@
 #include <assert.h>
 #include <stdexcept>
 #include <utility>
+#include <type_traits>
 
 #include "graph_concepts.h"
 #include "gcore.h"
+#include "views.h"
+#include "FlatHashMap.h"
+#include "SlabArray.h"
+#include "SmallVector.h"
+
+#define HUB_THRESHOLD 256
+
+/* Neighbours a NodeAL keeps inside itself before its list goes to the heap. With one, the
+wrapper of a graph with weights no bigger than a pointer takes exactly a cache line */
+#define INLINE_NEIGHBOURS 1
 
 
 using namespace std;
@@ -22,6 +33,23 @@ class NodeAL;
 template <typename IdType, typename WeightType, typename DataType>
 requires Comparable<IdType> && Numeric<WeightType>
 class GraphAL;
+template <typename IdType, typename WeightType, typename DataType>
+requires Comparable<IdType> && Numeric<WeightType>
+class GraphCSR;
+
+/* The out-edges of a NodeAL, as (neighbour, weight) pairs */
+template <typename IdType, typename WeightType, typename DataType>
+using NeighbourList = SmallVector<pair<NodeAL<IdType, WeightType, DataType>*, WeightType>, INLINE_NEIGHBOURS>;
+
+
+/*! How a GraphAL looks a node up in the neighbour list of another node. In linear mode (the
+default) the neighbours are kept in insertion order and every adjacency check is a scan. In sorted
+mode the neighbours are kept sorted by internal id and looked up by binary search, and the list of a
+node whose degree grows past the hub threshold gets a hash index instead. */
+enum class AdjacencyMode{
+	linear,
+	sorted
+};
 
 
 /************************* GraphAL Class ****************************/
@@ -32,53 +60,94 @@ template <typename IdType, typename WeightType, typename DataType>
 requires Comparable<IdType> && Numeric<WeightType>
 class GraphAL{
 friend class NodeAL<IdType, WeightType, DataType>;
+friend class GraphCSR<IdType, WeightType, DataType>;
 public:
 
 	using id_type = IdType;
 	using weight_type = WeightType;
 	using data_type = DataType;
 
+	/*! Iterates the neighbour list of a node in place. Yields the neighbouring Node, or the
+	(Node, weight) pair when WithWeight is set */
+	template <bool WithWeight>
+	class adjacency_iterator{
+	public:
+		using base_iterator = typename NeighbourList<IdType, WeightType, DataType>::const_iterator;
+		using value_type = typename conditional<WithWeight,
+			pair<const shared_ptr<Node<IdType, DataType>>&, WeightType>,
+			const shared_ptr<Node<IdType, DataType>>&>::type;
+
+		adjacency_iterator(base_iterator it) : it(it) {}
+
+		inline value_type operator*() const {
+			if constexpr (WithWeight){
+				return value_type(it->first->user_node_p, it->second);
+			}else{
+				return it->first->user_node_p;
+			}
+		}
+
+		inline adjacency_iterator& operator++(){
+			++it;
+			return *this;
+		}
+
+		inline bool operator==(const adjacency_iterator& rhs) const {
+			return it == rhs.it;
+		}
+
+		inline bool operator!=(const adjacency_iterator& rhs) const {
+			return it != rhs.it;
+		}
+
+	private:
+		base_iterator it;
+	};
+
+	using neighbour_range = Range<adjacency_iterator<false>>;
+	using out_edge_range = Range<adjacency_iterator<true>>;
+
 	static inline shared_ptr<GraphAL<IdType, WeightType, DataType>> create_graph(){
 		shared_ptr<GraphAL<IdType, WeightType, DataType>> p = make_shared<GraphAL<IdType, WeightType, DataType>>();
 		return p;
 	}
 
+	/* The wrappers are destroyed in place, their slabs go with the slab array */
 	~GraphAL(){
 		for(auto x : adjacency_list){
 			if(x == nullptr) continue;
-			delete x;
+			wrappers.destroy(x->internal_id);
 		}
 	}
 
 	/* Checks if the node is in the graph */
 	inline bool has_node(const shared_ptr<Node<IdType, DataType>> x){
-		return node_in_graph(x);
+		return find_wrapper_p(x) != nullptr;
 	}
 
+	/*! The fingerprint of the nodes and edges of the graph, see node_fingerprint. It is kept up to
+	date by every change, so reading it is free. Equal graphs have equal fingerprints */
+	inline uint64_t fingerprint() const {
+		return content_fingerprint;
+	}
 
-	bool has_edge(const shared_ptr<Node<IdType, DataType>> src, const WeightType w, 
-		const shared_ptr<Node<IdType, DataType>> dst){
-
-		/* First we need to check if the nodes are in the graph */
-		if(!nodes_in_graph(src, dst)){
-			return false;
-		}
+	/*! Number of nodes in the graph */
+	inline int num_nodes() const {
+		return id_map.size();
+	}
 
-		/* Get hold of the wrappers */
-		NodeAL<IdType, WeightType, DataType> * src_p = get_wrapper_p(src);
-		NodeAL<IdType, WeightType, DataType> * dst_p = get_wrapper_p(dst);
 
+	bool has_edge(const shared_ptr<Node<IdType, DataType>> src, const WeightType w, 
+		const shared_ptr<Node<IdType, DataType>> dst){
 
-		if(!adjacent(src_p, dst_p)){
+		/* Get hold of the wrappers, if the nodes are in the graph */
+		NodeAL<IdType, WeightType, DataType> * src_p = find_wrapper_p(src);
+		NodeAL<IdType, WeightType, DataType> * dst_p = find_wrapper_p(dst);
+		if(src_p == nullptr || dst_p == nullptr){
 			return false;
 		}
 
-		auto it = 
-		find_if(src_p->neighbours.begin(), 
-		src_p->neighbours.end(),
-    	[&](const pair<NodeAL<IdType, WeightType, DataType>*, WeightType>& element)
-    		{return element.first == dst_p;});
-
+		auto it = find_neighbour(src_p, dst_p);
 		if(it == src_p->neighbours.end()){
 			return false;
 		}
@@ -96,11 +165,10 @@ public:
 		
 		vector<shared_ptr<Edge<IdType, WeightType, DataType>>> temp;
 		
-		if(!node_in_graph(x))
+		auto wrapper_p = find_wrapper_p(x);
+		if(wrapper_p == nullptr)
 			throw std::invalid_argument("node not in the graph");
 
-		auto wrapper_p = get_wrapper_p(x);
-
 		/* Go through the list of pairs constructing Edge objects */
 		for(auto edge : wrapper_p->neighbours){
 			temp.push_back(create_edge(wrapper_p->user_node_p, edge.second, (edge.first)->user_node_p));
@@ -127,17 +195,54 @@ public:
 		return temp;
 	}
 
+	/* Same as edges_of_node, as EdgeRefs to the nodes held by the graph instead of new Edges */
+	vector<EdgeRef<IdType, WeightType, DataType>> edge_refs_of_node(const shared_ptr<Node<IdType, DataType>> x){
+
+		auto wrapper_p = find_wrapper_p(x);
+		if(wrapper_p == nullptr)
+			throw std::invalid_argument("node not in the graph");
+
+		vector<EdgeRef<IdType, WeightType, DataType>> temp;
+		temp.reserve(wrapper_p->neighbours.size());
+		for(auto& edge : wrapper_p->neighbours){
+			temp.push_back({&wrapper_p->user_node_p, &edge.first->user_node_p, edge.second});
+		}
+		return temp;
+	}
+
+	/* Same as get_edges, as EdgeRefs */
+	vector<EdgeRef<IdType, WeightType, DataType>> edge_refs(){
+
+		size_t count = 0;
+		for(auto wrapper_p : adjacency_list){
+			if(wrapper_p != nullptr)
+				count += wrapper_p->neighbours.size();
+		}
+
+		vector<EdgeRef<IdType, WeightType, DataType>> temp;
+		temp.reserve(count);
+		for(auto wrapper_p : adjacency_list){
+			if(wrapper_p == nullptr) continue;
+			for(auto& edge : wrapper_p->neighbours){
+				temp.push_back({&wrapper_p->user_node_p, &edge.first->user_node_p, edge.second});
+			}
+		}
+		return temp;
+	}
+
 	/* Returns an edge between two nodes in a graph, if such exists. Throws exp otherwise */
 	shared_ptr<Edge<IdType, WeightType, DataType>> get_edge(shared_ptr<Node<IdType, DataType>> src,
 		shared_ptr<Node<IdType, DataType>> dst){
 
-		if(!this->adjacent(src, dst))
-			throw std::invalid_argument("edge does not exist");
+		auto src_wp = find_wrapper_p(src);
+		auto dst_wp = find_wrapper_p(dst);
+		if(src_wp == nullptr || dst_wp == nullptr)
+			throw std::invalid_argument("node not in the graph");
 
-		auto src_wp = get_wrapper_p(src);
-		auto dst_wp = get_wrapper_p(dst);
+		auto edge_p = find_neighbour(src_wp, dst_wp);
+		if(edge_p == src_wp->neighbours.end())
+			throw std::invalid_argument("edge does not exist");
 
-		auto edge_p = get_edge(src_wp, dst_wp);
 		return create_edge(src, (*edge_p).second, dst);
 	}
 
@@ -159,11 +264,12 @@ public:
 	vector<shared_ptr<Node<IdType, DataType>>> neighbours(const shared_ptr<Node<IdType, DataType>> src){
 
 		/* Check if the node is in the graph */
-		if(!node_in_graph(src))
+		auto src_p = find_wrapper_p(src);
+		if(src_p == nullptr)
 			throw std::invalid_argument("node not in the graph");
 
 		/* Get the vector of neighbours that is stored in the wrapper */
-		auto edges = get_wrapper_p(src)->neighbours;
+		auto& edges = src_p->neighbours;
 		vector<shared_ptr<Node<IdType, DataType>>> temp;
 
 		/* Get the pointers to all the edges */
@@ -175,43 +281,102 @@ public:
 		return temp;
 	}
 
-	/* Checks if exists a directed edge from src to dst */
-	bool adjacent(const shared_ptr<Node<IdType, DataType>> src, const shared_ptr<Node<IdType, DataType>> dst){
+	/* Same as neighbours, but walks the neighbour list in place instead of copying it */
+	neighbour_range neighbours_view(const shared_ptr<Node<IdType, DataType>>& src){
+
+		auto src_p = find_wrapper_p(src);
+		if(src_p == nullptr)
+			throw std::invalid_argument("node not in the graph");
+
+		auto& edges = src_p->neighbours;
+		return neighbour_range(edges.cbegin(), edges.cend());
+	}
+
+	/* Walks the outgoing edges of the node in place, as (dst, weight) pairs */
+	out_edge_range out_edges(const shared_ptr<Node<IdType, DataType>>& src){
 
-		if(!nodes_in_graph(src, dst)){
+		auto src_p = find_wrapper_p(src);
+		if(src_p == nullptr)
 			throw std::invalid_argument("node not in the graph");
+
+		auto& edges = src_p->neighbours;
+		return out_edge_range(edges.cbegin(), edges.cend());
+	}
+
+	/* Function returns the nodes that have an edge to dst. Needs the in-edges to be tracked */
+	vector<shared_ptr<Node<IdType, DataType>>> predecessors(const shared_ptr<Node<IdType, DataType>> dst){
+
+		vector<shared_ptr<Node<IdType, DataType>>> temp;
+		for(auto edge : in_edges(dst)){
+			temp.push_back(edge.first);
 		}
+		return temp;
+	}
 
-		if(adjacent(get_wrapper_p(src), get_wrapper_p(dst))){
-			return true;
+	/* Walks the incoming edges of the node in place, as (src, weight) pairs. Needs the
+	in-edges to be tracked */
+	out_edge_range in_edges(const shared_ptr<Node<IdType, DataType>>& dst){
+
+		if(!in_edges_tracked)
+			throw std::logic_error("in-edges are not tracked");
+
+		auto dst_p = find_wrapper_p(dst);
+		if(dst_p == nullptr)
+			throw std::invalid_argument("node not in the graph");
+
+		if(!dst_p->in_neighbours)
+			return out_edge_range(nullptr, nullptr);
+		auto& edges = *dst_p->in_neighbours;
+		return out_edge_range(edges.cbegin(), edges.cend());
+	}
+
+	/* Checks if exists a directed edge from src to dst */
+	bool adjacent(const shared_ptr<Node<IdType, DataType>> src, const shared_ptr<Node<IdType, DataType>> dst){
+
+		auto src_p = find_wrapper_p(src);
+		auto dst_p = find_wrapper_p(dst);
+		if(src_p == nullptr || dst_p == nullptr){
+			throw std::invalid_argument("node not in the graph");
 		}
 
-		return false;
+		return adjacent(src_p, dst_p);
 	}
 
 	/* Adds a node to the graph */
 	bool add_node(const shared_ptr<Node<IdType, DataType>> x){
 		
-		/* Check if the vertex is already in the graph */
-		if(node_in_graph(x)){
+		/* Check if the vertex is already in the graph. The slot found here
+		is where the new mapping goes, so the map is probed only once */
+		auto& slot = id_map[x->get_id()];
+		if(slot != nullptr){
 			throw std::invalid_argument("node already added");
 		}
 
-		/* Create the wrapper and add it to adjacency list */
-		NodeAL<IdType, WeightType, DataType>* vertex_p = 
-			new NodeAL<IdType, WeightType, DataType>(this, x);
-		int internal_id = vertex_p->internal_id;
+		emplace_node(x, slot);
+		return true;
+	}
 
-		//TODO: factor this out into a helper?
-		if(internal_id == next_unique_id - 1){
-			adjacency_list.push_back(vertex_p);
-		}else{
-			adjacency_list[internal_id] = vertex_p;
+	/* Adds all the nodes of the batch. The batch is validated first: if one of the nodes is
+	already in the graph, or appears twice, an exception is thrown and nothing is added */
+	bool add_nodes(const vector<shared_ptr<Node<IdType, DataType>>>& xs){
+
+		FlatHashMap<IdType, bool> batch;
+		batch.reserve(xs.size());
+		for(auto& x : xs){
+			bool& seen = batch[x->get_id()];
+			if(seen || find_wrapper_p(x) != nullptr){
+				throw std::invalid_argument("node already added");
+			}
+			seen = true;
+		}
+
+		/* Make room once, then append */
+		id_map.reserve(id_map.size() + xs.size());
+		adjacency_list.reserve(adjacency_list.size() + xs.size());
+		wrappers.reserve(next_unique_id + max(0l, (long) xs.size() - (long) free_ids.size()));
+		for(auto& x : xs){
+			emplace_node(x, id_map[x->get_id()]);
 		}
-		
-		/* Add the new mapping into the map */
-		id_map[x->get_id()] = vertex_p;
-		assert(id_map.find(x->get_id())->second == vertex_p); //ASSERT
 		return true;
 	}
 
@@ -219,28 +384,47 @@ public:
 	bool remove_node(const shared_ptr<Node<IdType, DataType>> x){
 
 		/* Check if the vertex is not in the graph */
-		if(!node_in_graph(x)){
+		auto wrapper_p = find_wrapper_p(x);
+		if(wrapper_p == nullptr){
 			throw std::invalid_argument("node not in the graph");
 		}
 
 		/* Get the internal id of the wrapper of x */
-		int internal_id = id_map.find(x->get_id())->second->internal_id;
+		int internal_id = wrapper_p->internal_id;
 
-		/* Remove all outgoing endes from the vertex */
-		adjacency_list[internal_id]->neighbours.clear();
+		/* The outgoing edges go with the wrapper, the incoming ones through erase_neighbour */
+		content_fingerprint -= node_fingerprint(wrapper_p->user_node_p->get_id());
+		for(auto& edge : wrapper_p->neighbours){
+			content_fingerprint -= edge_share(wrapper_p, edge.first, edge.second);
+		}
 
-		/* Destroy incoming edges */
-		for(auto node_p : adjacency_list){
-			if(node_p == nullptr) continue;
-			for(int i = 0; i < node_p->neighbours.size(); ++i){
-				if((node_p->neighbours[i]).first == get_wrapper_p(x))
-					node_p->neighbours.erase(node_p->neighbours.begin() + i);
+		if(in_edges_tracked){
+
+			/* Only the lists of the neighbours of x refer to it, so destroy the incoming
+			edges through the in-edge list and drop x from the in-edge lists of its targets */
+			if(wrapper_p->in_neighbours){
+				for(auto& edge : *wrapper_p->in_neighbours){
+					if(edge.first == wrapper_p) continue;
+					erase_neighbour(edge.first, find_neighbour(edge.first, wrapper_p));
+				}
+			}
+			for(auto& edge : wrapper_p->neighbours){
+				if(edge.first == wrapper_p) continue;
+				erase_in_neighbour(edge.first, wrapper_p);
+			}
+		}else{
+
+			/* Destroy incoming edges */
+			for(auto node_p : adjacency_list){
+				if(node_p == nullptr || node_p == wrapper_p) continue;
+				auto it = find_neighbour(node_p, wrapper_p);
+				if(it != node_p->neighbours.end())
+					erase_neighbour(node_p, it);
 			}
 		}
 
-		/* Delete the wrapper */
-		//TODO: discuss the naked delete and smart pointers and etc
-		delete adjacency_list[internal_id];
+		/* Destroy the wrapper, with its outgoing edges. Its slot is reused with the id */
+		wrappers.destroy(internal_id);
 
 		/* This slot is going t be resused when id recycling kicks in*/
 		adjacency_list[internal_id] = nullptr;
@@ -263,15 +447,13 @@ public:
 		/* All we need to do here is to add a pointer
 		to n2 to the neighbours of n1*/
 
-		/* First we need to check if the nodes are in the graph */
-		if(!nodes_in_graph(src, dst)){
+		/* Get hold of the wrappers, if the nodes are in the graph */
+		NodeAL<IdType, WeightType, DataType> * src_p = find_wrapper_p(src);
+		NodeAL<IdType, WeightType, DataType> * dst_p = find_wrapper_p(dst);
+		if(src_p == nullptr || dst_p == nullptr){
 			throw std::invalid_argument("src or dst of the edge not in the graph");
 		}
 
-		/* Get hold of the wrappers */
-		NodeAL<IdType, WeightType, DataType> * src_p = get_wrapper_p(src);
-		NodeAL<IdType, WeightType, DataType> * dst_p = get_wrapper_p(dst);
-
 		/* Check if the edge already exists, if it does, 
 		throw an exception */
 		if(adjacent(src_p, dst_p)){
@@ -279,8 +461,124 @@ public:
 		}
 
 		/* Now we are sure the edge is not already represented,
-		so lets just add it to the back of the vector */
-		src_p->neighbours.push_back(make_pair(dst_p, w));
+		so lets just add it to the vector */
+		insert_neighbour(src_p, dst_p, w);
+		if(in_edges_tracked){
+			in_list(dst_p).push_back(make_pair(src_p, w));
+		}
+		content_fingerprint += edge_share(src_p, dst_p, w);
+
+		return true;
+	}
+
+	/* Adds all the edges of the batch of (src id, weight, dst id) records. The batch is sorted
+	once, repeated records are collapsed and the whole batch is validated before anything is added:
+	if a node is not in the graph, an edge already exists, or the batch holds two weights for one
+	edge, an exception is thrown and the graph is left as it was. Without repeats_allowed, a record
+	repeated with the same weight is refused too. In linear mode the new edges are appended in the
+	order of the batch, in sorted mode they are merged into place. */
+	bool add_edges(const vector<EdgeRecord<IdType, WeightType>>& batch, bool repeats_allowed = true){
+
+		vector<resolved_edge> edges;
+		edges.reserve(batch.size());
+
+		/* Resolve every id once, checking membership on the way */
+		for(auto& record : batch){
+			auto src_pp = id_map.find(record.src);
+			auto dst_pp = id_map.find(record.dst);
+			if(src_pp == nullptr || dst_pp == nullptr){
+				throw std::invalid_argument("src or dst of the edge not in the graph");
+			}
+			edges.push_back(resolved_edge{*src_pp, *dst_pp, record.weight, edges.size()});
+		}
+
+		/* Group the edges by source, and sort each group by destination */
+		sort(edges.begin(), edges.end(), [](const resolved_edge& a, const resolved_edge& b){
+			if(a.src_p->internal_id != b.src_p->internal_id)
+				return a.src_p->internal_id < b.src_p->internal_id;
+			return a.dst_p->internal_id < b.dst_p->internal_id;
+		});
+
+		/* Repeated records are now neighbours */
+		size_t kept = 0;
+		for(size_t i = 0; i < edges.size(); ++i){
+			if(kept > 0 && edges[kept - 1].src_p == edges[i].src_p && edges[kept - 1].dst_p == edges[i].dst_p){
+				if(!repeats_allowed || edges[kept - 1].w != edges[i].w){
+					throw std::invalid_argument("edge already exists");
+				}
+				continue;
+			}
+			edges[kept++] = edges[i];
+		}
+		edges.resize(kept);
+
+		/* Check every group against the edges its source already has, by merging
+		the group with the sorted ids of the existing neighbours */
+		vector<long> existing;
+		for(size_t first = 0, last; first < edges.size(); first = last){
+			auto src_p = edges[first].src_p;
+			for(last = first; last < edges.size() && edges[last].src_p == src_p; ++last);
+			if(src_p->neighbours.empty()) continue;
+
+			existing.clear();
+			for(auto& edge : src_p->neighbours){
+				existing.push_back(edge.first->internal_id);
+			}
+			sort(existing.begin(), existing.end());
+
+			auto it = existing.begin();
+			for(size_t i = first; i < last; ++i){
+				it = lower_bound(it, existing.end(), edges[i].dst_p->internal_id);
+				if(it != existing.end() && *it == edges[i].dst_p->internal_id){
+					throw std::invalid_argument("edge already exists");
+				}
+			}
+		}
+
+		/* Everything is valid. Linear mode keeps the lists in insertion order, so the edges go back
+		to the order of the batch and are appended one by one */
+		if(adjacency_mode == AdjacencyMode::linear){
+			sort(edges.begin(), edges.end(), [](const resolved_edge& a, const resolved_edge& b){
+				return a.position < b.position;
+			});
+			for(auto& edge : edges){
+				edge.src_p->neighbours.push_back(make_pair(edge.dst_p, edge.w));
+				content_fingerprint += edge_share(edge.src_p, edge.dst_p, edge.w);
+			}
+		}
+
+		/* Sorted mode appends each group to the list of its source and merges it into place */
+		for(size_t first = 0, last; adjacency_mode == AdjacencyMode::sorted && first < edges.size(); first = last){
+			auto src_p = edges[first].src_p;
+			for(last = first; last < edges.size() && edges[last].src_p == src_p; ++last);
+
+			auto& list = src_p->neighbours;
+			size_t old_size = list.size();
+			list.reserve(old_size + (last - first));
+			for(size_t i = first; i < last; ++i){
+				list.push_back(make_pair(edges[i].dst_p, edges[i].w));
+				content_fingerprint += edge_share(src_p, edges[i].dst_p, edges[i].w);
+			}
+
+			if(src_p->neighbour_index){
+				for(size_t i = old_size; i < list.size(); ++i){
+					(*src_p->neighbour_index)[list[i].first] = i;
+				}
+			}else{
+				inplace_merge(list.begin(), list.begin() + old_size, list.end(),
+					[](const pair<NodeAL<IdType, WeightType, DataType>*, WeightType>& a,
+						const pair<NodeAL<IdType, WeightType, DataType>*, WeightType>& b)
+						{return a.first->internal_id < b.first->internal_id;});
+				if(list.size() > hub_threshold)
+					build_neighbour_index(src_p);
+			}
+		}
+
+		if(in_edges_tracked){
+			for(auto& edge : edges){
+				in_list(edge.dst_p).push_back(make_pair(edge.src_p, edge.w));
+			}
+		}
 
 		return true;
 	}
@@ -289,26 +587,24 @@ public:
 	bool remove_edge(const shared_ptr<Node<IdType, DataType>> src,
 		const shared_ptr<Node<IdType, DataType>> dst){
 
-		if(!nodes_in_graph(src, dst)){
+		/* Get hold of the implementation wrappers */
+		NodeAL<IdType, WeightType, DataType> * src_p = find_wrapper_p(src);
+		NodeAL<IdType, WeightType, DataType> * dst_p = find_wrapper_p(dst);
+		if(src_p == nullptr || dst_p == nullptr){
 			throw std::invalid_argument("src or dst of the edge not in the graph");
 		}
 
-		/* Get hold of the implementation wrappers */
-		NodeAL<IdType, WeightType, DataType> * src_p = get_wrapper_p(src);
-		NodeAL<IdType, WeightType, DataType> * dst_p = get_wrapper_p(dst);
-
 		/* If they are already not adjacent, nothing to remove*/
-		if(!adjacent(src_p, dst_p)){
+		auto it = find_neighbour(src_p, dst_p);
+		if(it == src_p->neighbours.end()){
 			throw std::invalid_argument("edge does not exist");
 		}
 
-		/* Erase the neighbour element. Should not fail
-		since we know they are adjacent. */
-		/* #readability */
-		src_p->neighbours.erase(find_if(src_p->neighbours.begin(), 
-		src_p->neighbours.end(),
-    	[&](const pair<NodeAL<IdType, WeightType, DataType>*, WeightType>& element)
-    		{return element.first == dst_p;}));
+		/* Erase the neighbour element */
+		erase_neighbour(src_p, it);
+		if(in_edges_tracked){
+			erase_in_neighbour(dst_p, src_p);
+		}
 
 		return true;
 	}
@@ -325,9 +621,114 @@ public:
 		}
 	}
 
+	/*! Switches the way neighbour lists are searched, see AdjacencyMode. In sorted mode, nodes with
+	more than hub_threshold neighbours get a hash index. The existing lists are reorganized, so this
+	is best called on an empty graph. Note that the mode decides the order in which neighbours are
+	returned. */
+	void set_adjacency_mode(AdjacencyMode mode, size_t hub_threshold = HUB_THRESHOLD){
+
+		adjacency_mode = mode;
+		this->hub_threshold = hub_threshold;
+
+		for(auto node_p : adjacency_list){
+			if(node_p == nullptr) continue;
+			node_p->neighbour_index.reset();
+
+			if(mode == AdjacencyMode::sorted){
+				if(node_p->neighbours.size() > hub_threshold){
+					build_neighbour_index(node_p);
+				}else{
+					sort(node_p->neighbours.begin(), node_p->neighbours.end(),
+						[](const pair<NodeAL<IdType, WeightType, DataType>*, WeightType>& a,
+							const pair<NodeAL<IdType, WeightType, DataType>*, WeightType>& b)
+							{return a.first->internal_id < b.first->internal_id;});
+				}
+			}
+		}
+	}
+
+	/*! Turns the in-edge lists on or off. With in-edges tracked, every node also keeps the list
+	of edges that point to it: predecessors and in_edges can be answered, and remove_node only
+	touches the lists of the neighbours of the removed node instead of every list in the graph.
+	The price is a second copy of every edge. */
+	void track_in_edges(bool track = true){
+
+		in_edges_tracked = track;
+
+		for(auto node_p : adjacency_list){
+			if(node_p == nullptr) continue;
+			node_p->in_neighbours.reset();
+		}
+		if(!track)
+			return;
+
+		for(auto node_p : adjacency_list){
+			if(node_p == nullptr) continue;
+			for(auto& edge : node_p->neighbours){
+				in_list(edge.first).push_back(make_pair(node_p, edge.second));
+			}
+		}
+	}
+
+	/*! Checks if the in-edges are tracked, see track_in_edges */
+	inline bool tracks_in_edges() const {
+		return in_edges_tracked;
+	}
+
+	/*! Returns a copy of the graph that shares its Nodes. The storage is copied as it is: every
+	wrapper goes to the same internal id, so the lists are copied in order with their pointers
+	remapped, and nothing is looked up or validated again. The copy keeps the adjacency mode, the
+	in-edges and the free ids of the graph */
+	shared_ptr<GraphAL<IdType, WeightType, DataType>> clone(){
+
+		auto copy = create_graph();
+		copy->next_unique_id = next_unique_id;
+		copy->free_ids = free_ids;
+		copy->adjacency_mode = adjacency_mode;
+		copy->hub_threshold = hub_threshold;
+		copy->in_edges_tracked = in_edges_tracked;
+		copy->content_fingerprint = content_fingerprint;
+
+		/* The wrappers first, so that every pointer has somewhere to go */
+		copy->adjacency_list.assign(adjacency_list.size(), nullptr);
+		copy->wrappers.reserve(adjacency_list.size());
+		copy->id_map.reserve(id_map.size());
+		for(auto node_p : adjacency_list){
+			if(node_p == nullptr) continue;
+			auto copy_p = copy->wrappers.emplace(node_p->internal_id, node_p->internal_id, node_p->user_node_p);
+			copy->adjacency_list[node_p->internal_id] = copy_p;
+			copy->id_map[node_p->user_node_p->get_id()] = copy_p;
+		}
+
+		for(auto node_p : adjacency_list){
+			if(node_p == nullptr) continue;
+			auto copy_p = copy->adjacency_list[node_p->internal_id];
+
+			copy_p->neighbours.reserve(node_p->neighbours.size());
+			for(auto& edge : node_p->neighbours){
+				copy_p->neighbours.push_back(make_pair(copy->adjacency_list[edge.first->internal_id], edge.second));
+			}
+			if(node_p->in_neighbours){
+				auto& in_edges = copy->in_list(copy_p);
+				in_edges.reserve(node_p->in_neighbours->size());
+				for(auto& edge : *node_p->in_neighbours){
+					in_edges.push_back(make_pair(copy->adjacency_list[edge.first->internal_id], edge.second));
+				}
+			}
+			if(node_p->neighbour_index){
+				copy->build_neighbour_index(copy_p);
+			}
+		}
+		return copy;
+	}
+
 	/* Need to add more constructors such as list initialization here*/
 	GraphAL(){
 		next_unique_id = 0;
+		content_fingerprint = 0;
+		adjacency_mode = AdjacencyMode::linear;
+		hub_threshold = HUB_THRESHOLD;
+		in_edges_tracked = false;
 	}
 /*	TODO: Not sure how these factor into our library
  *	get_vertex_value(G, x): returns the value associated with the vertex x;
@@ -338,13 +739,35 @@ private:
 	to the neighbours of the node from its wrapper. The penalty – vertex
 	removal */
 	vector<NodeAL<IdType, WeightType, DataType>*> adjacency_list;
+
+	/* The wrappers themselves, in the slot of their internal id */
+	SlabArray<NodeAL<IdType, WeightType, DataType>> wrappers;
 	// Need this map to go from Node -> NodeAL
-	map<IdType, NodeAL<IdType, WeightType, DataType>*> id_map;
+	FlatHashMap<IdType, NodeAL<IdType, WeightType, DataType>*> id_map;
 
 	/* Same idea as for GraphAM here */
 	long next_unique_id;
 	vector<int> free_ids;
 
+	/* See set_adjacency_mode */
+	AdjacencyMode adjacency_mode;
+	size_t hub_threshold;
+
+	/* See track_in_edges */
+	bool in_edges_tracked;
+
+	/* See fingerprint */
+	uint64_t content_fingerprint;
+
+	/* An edge of a batch, with its nodes already looked up */
+	struct resolved_edge{
+		NodeAL<IdType, WeightType, DataType> * src_p;
+		NodeAL<IdType, WeightType, DataType> * dst_p;
+		WeightType w;
+		/* Where the edge is in the batch */
+		size_t position;
+	};
+
 	/* Function hands out the new id when a vertex is added*/
 	inline long get_new_id(){
 		if(free_ids.empty()){
@@ -356,58 +779,156 @@ private:
 		}
 	}
 
-	inline bool return_id(int internal_id){
+	inline void return_id(int internal_id){
 		free_ids.push_back(internal_id);
 	}
 
-	inline bool node_in_graph(const shared_ptr<Node<IdType, DataType>> x){
-		if(id_map.find(x->get_id()) != id_map.end()){
-			return true;
+	/* Creates the wrapper of x, puts it in the adjacency list and stores it in slot,
+	the entry of id_map for x. Assumes x is not in the graph yet */
+	void emplace_node(const shared_ptr<Node<IdType, DataType>>& x,
+		NodeAL<IdType, WeightType, DataType>*& slot){
+
+		/* Create the wrapper and add it to adjacency list */
+		int internal_id = get_new_id();
+		NodeAL<IdType, WeightType, DataType>* vertex_p = wrappers.emplace(internal_id, internal_id, x);
+
+		if(internal_id == next_unique_id - 1){
+			adjacency_list.push_back(vertex_p);
+		}else{
+			adjacency_list[internal_id] = vertex_p;
 		}
-		return false;
+		
+		/* Add the new mapping into the map */
+		slot = vertex_p;
+		content_fingerprint += node_fingerprint(x->get_id());
+		assert(*id_map.find(x->get_id()) == vertex_p); //ASSERT
 	}
 
-	inline bool nodes_in_graph(const shared_ptr<Node<IdType, DataType>> x,
-		const shared_ptr<Node<IdType, DataType>> y){
-		return (node_in_graph(x) && node_in_graph(y));
+	/* Returns the wrapper of x, or nullptr if x is not in the graph. The membership
+	check and the lookup are the same probe of id_map */
+	inline NodeAL<IdType, WeightType, DataType>* find_wrapper_p(const shared_ptr<Node<IdType, DataType>>& x){
+		auto wrapper_pp = id_map.find(x->get_id());
+		if(wrapper_pp == nullptr){
+			return nullptr;
+		}
+		return *wrapper_pp;
 	}
 
-	/* NOTE: Assumes x is in the graph */
-	NodeAL<IdType, WeightType, DataType>* get_wrapper_p(const shared_ptr<Node<IdType, DataType>> x){
-		return id_map.find(x->get_id())->second;
+	bool adjacent(NodeAL<IdType, WeightType, DataType> * src_p, 
+		NodeAL<IdType, WeightType, DataType> * dst_p){
+		return find_neighbour(src_p, dst_p) != src_p->neighbours.end();
 	}
 
-	bool adjacent(const NodeAL<IdType, WeightType, DataType> * src_p, 
-		const NodeAL<IdType, WeightType, DataType> * dst_p){
+	/* Returns the position of dst_p in the neighbours of src_p, or the end of
+	the neighbours if the two are not adjacent */
+	auto find_neighbour(NodeAL<IdType, WeightType, DataType> * src_p, 
+		NodeAL<IdType, WeightType, DataType> * dst_p){
+
+		auto& edges = src_p->neighbours;
+
+		/* Hubs have a hash index from neighbour to position */
+		if(src_p->neighbour_index){
+			auto position_p = src_p->neighbour_index->find(dst_p);
+			if(position_p == nullptr)
+				return edges.end();
+			return edges.begin() + *position_p;
+		}
+
+		if(adjacency_mode == AdjacencyMode::sorted){
+			auto it = lower_bound(edges.begin(), edges.end(), dst_p->internal_id,
+				[](const pair<NodeAL<IdType, WeightType, DataType>*, WeightType>& element, long id)
+					{return element.first->internal_id < id;});
+			if(it != edges.end() && it->first == dst_p)
+				return it;
+			return edges.end();
+		}
 
 		/*Lets findout if dst_p in in neghbours of src_p */
-		auto it = 
-		find_if(src_p->neighbours.begin(), 
-		src_p->neighbours.end(),
+		return find_if(edges.begin(), edges.end(),
     	[&](const pair<NodeAL<IdType, WeightType, DataType>*, WeightType>& element)
     		{return element.first == dst_p;});
+	}
 
-		if(it != src_p->neighbours.end())
-			return true;
-		
-		return false;
+	/* Adds dst_p to the neighbours of src_p. Assumes they are not adjacent yet */
+	void insert_neighbour(NodeAL<IdType, WeightType, DataType> * src_p, 
+		NodeAL<IdType, WeightType, DataType> * dst_p, const WeightType w){
+
+		auto& edges = src_p->neighbours;
+
+		if(src_p->neighbour_index){
+			(*src_p->neighbour_index)[dst_p] = edges.size();
+			edges.push_back(make_pair(dst_p, w));
+			return;
+		}
+
+		if(adjacency_mode == AdjacencyMode::sorted){
+			auto it = lower_bound(edges.begin(), edges.end(), dst_p->internal_id,
+				[](const pair<NodeAL<IdType, WeightType, DataType>*, WeightType>& element, long id)
+					{return element.first->internal_id < id;});
+			edges.insert(it, make_pair(dst_p, w));
+
+			/* The node just became a hub */
+			if(edges.size() > hub_threshold)
+				build_neighbour_index(src_p);
+			return;
+		}
+
+		edges.push_back(make_pair(dst_p, w));
 	}
 
-	auto get_edge(const NodeAL<IdType, WeightType, DataType> * src_p, 
-		const NodeAL<IdType, WeightType, DataType> * dst_p){
+	/* Removes the neighbour at position it from the neighbours of src_p */
+	void erase_neighbour(NodeAL<IdType, WeightType, DataType> * src_p, 
+		typename NeighbourList<IdType, WeightType, DataType>::iterator it){
 
-		/*Lets findout if dst_p in in neghbours of src_p */
-		auto it = 
-		find_if(src_p->neighbours.begin(), 
-		src_p->neighbours.end(),
+		auto& edges = src_p->neighbours;
+		content_fingerprint -= edge_share(src_p, it->first, it->second);
+
+		/* Indexed lists are unordered, so fill the hole with the last element */
+		if(src_p->neighbour_index){
+			src_p->neighbour_index->erase(it->first);
+			if(it != edges.end() - 1){
+				*it = edges.back();
+				(*src_p->neighbour_index)[it->first] = it - edges.begin();
+			}
+			edges.pop_back();
+			return;
+		}
+
+		edges.erase(it);
+	}
+
+	/* Removes src_p from the in-edge list of dst_p. In-edge lists are unordered */
+	void erase_in_neighbour(NodeAL<IdType, WeightType, DataType> * dst_p, 
+		NodeAL<IdType, WeightType, DataType> * src_p){
+
+		auto& edges = *dst_p->in_neighbours;
+		auto it = find_if(edges.begin(), edges.end(),
     	[&](const pair<NodeAL<IdType, WeightType, DataType>*, WeightType>& element)
-    		{return element.first == dst_p;});
+    		{return element.first == src_p;});
+		*it = edges.back();
+		edges.pop_back();
+	}
 
-		if(it != src_p->neighbours.end())
-			return it;
-		
-		//TODO: FIX
-		return it;
+	/* The in-edge list of node_p, created on first use so that graphs that do not track
+	in-edges pay one pointer per node for them */
+	inline NeighbourList<IdType, WeightType, DataType>& in_list(NodeAL<IdType, WeightType, DataType> * node_p){
+		if(!node_p->in_neighbours)
+			node_p->in_neighbours.reset(new NeighbourList<IdType, WeightType, DataType>());
+		return *node_p->in_neighbours;
+	}
+
+	/* The share of the edge in the fingerprint */
+	inline uint64_t edge_share(const NodeAL<IdType, WeightType, DataType> * src_p,
+		const NodeAL<IdType, WeightType, DataType> * dst_p, const WeightType w){
+		return edge_fingerprint(src_p->user_node_p->get_id(), w, dst_p->user_node_p->get_id());
+	}
+
+	void build_neighbour_index(NodeAL<IdType, WeightType, DataType> * node_p){
+		node_p->neighbour_index.reset(new FlatHashMap<NodeAL<IdType, WeightType, DataType>*, int>());
+		node_p->neighbour_index->reserve(node_p->neighbours.size());
+		for(size_t i = 0; i < node_p->neighbours.size(); ++i){
+			(*node_p->neighbour_index)[node_p->neighbours[i].first] = i;
+		}
 	}
 };
 
@@ -420,18 +941,16 @@ template <typename IdType, typename WeightType, typename DataType>
 requires Comparable<IdType> && Numeric<WeightType>
 class NodeAL{
 friend class GraphAL<IdType, WeightType, DataType>;
+friend class GraphCSR<IdType, WeightType, DataType>;
 public:
 
 using id_type = IdType;
 using weight_type = WeightType;
 using data_type = DataType;
-/* Need to think about other constructors here a little */
-	/* Existance of NodeAL only makes sense in the context of a graph */
-	NodeAL(GraphAL<IdType, WeightType, DataType>* graph,
-		const shared_ptr<Node<IdType, DataType>> user_node){
-		/* Get the new internal id */
-		internal_id = graph->get_new_id();
-
+	/* Existance of NodeAL only makes sense in the context of a graph, which hands out the
+	internal id and the memory */
+	NodeAL(long internal_id, const shared_ptr<Node<IdType, DataType>> user_node){
+		this->internal_id = internal_id;
 		user_node_p = user_node;
 	}
 
@@ -444,9 +963,16 @@ private:
 	/* Used to boost the performance of implementation graph*/
 	long internal_id;
 
-	/* This way, we avoid indexing into the adjacency list */
-	/* For now, lets store the Weight by value */
-	vector<pair<NodeAL<IdType, WeightType, DataType>*, WeightType>> neighbours;
+	/* This way, we avoid indexing into the adjacency list. Short lists stay inside the
+	wrapper, see INLINE_NEIGHBOURS */
+	NeighbourList<IdType, WeightType, DataType> neighbours;
+
+	/* Sources of the edges to this node, with their weights. Only allocated when the
+	graph tracks in-edges and the node has some */
+	unique_ptr<NeighbourList<IdType, WeightType, DataType>> in_neighbours;
+
+	/* Neighbour to position in neighbours. Only hubs in sorted mode have one */
+	unique_ptr<FlatHashMap<NodeAL<IdType, WeightType, DataType>*, int>> neighbour_index;
 	
 	/* Pointer to the user created node */
 	shared_ptr<Node<IdType, DataType>> user_node_p;
@@ -9,10 +9,14 @@
 #include <assert.h>
 #include <stdexcept>
 #include <utility>
+#include <type_traits>
 
 //#include "graph_concepts.h"
 #include "gcore.h"
 #include "SquareMatrix.h"
+#include "views.h"
+#include "FlatHashMap.h"
+#include "SlabArray.h"
 
 
 using namespace std;
@@ -22,50 +26,109 @@ class NodeAM;
 template <typename IdType, typename WeightType, typename DataType>
 //requires Comparable<IdType>
 class GraphAM;
+template <typename IdType, typename WeightType, typename DataType>
+requires Comparable<IdType> && Numeric<WeightType>
+class GraphCSR;
 
 
 /************************* GraphAM Class ****************************/
 /*! This class provides the adjacency matrix implementation for a Graph.
-Use this implementation when the graph is expected to be dense. */
+Use this implementation when the graph is expected to be dense. If the weights are irrelevant,
+use bool as the WeightType: the matrix is then stored one bit per entry. */
 template <typename IdType, typename WeightType, typename DataType>
 //requires Comparable<IdType>
 class GraphAM{
 friend class NodeAM<IdType, WeightType, DataType>;
+friend class GraphCSR<IdType, WeightType, DataType>;
 public:
 
 	using id_type = IdType;
 	using weight_type = WeightType;
 	using data_type = DataType;
 
+	/*! Iterates the non zero entries of a row of the adjacency matrix in place. Yields the
+	neighbouring Node, or the (Node, weight) pair when WithWeight is set */
+	template <bool WithWeight>
+	class adjacency_iterator{
+	public:
+		using value_type = typename conditional<WithWeight,
+			pair<const shared_ptr<Node<IdType, DataType>>&, WeightType>,
+			const shared_ptr<Node<IdType, DataType>>&>::type;
+
+		adjacency_iterator(GraphAM<IdType, WeightType, DataType>* graph, int row, int column)
+			: graph(graph), row(row), column(column) {}
+
+		inline value_type operator*() const {
+			auto& node_p = graph->wrapper_map[column]->user_node_p;
+			if constexpr (WithWeight){
+				return value_type(node_p, graph->adjacency_matrix.get_entry(row, column));
+			}else{
+				return node_p;
+			}
+		}
+
+		inline adjacency_iterator& operator++(){
+			column = graph->adjacency_matrix.next_non_zero(row, column + 1);
+			return *this;
+		}
+
+		inline bool operator==(const adjacency_iterator& rhs) const {
+			return column == rhs.column;
+		}
+
+		inline bool operator!=(const adjacency_iterator& rhs) const {
+			return column != rhs.column;
+		}
+
+	private:
+		GraphAM<IdType, WeightType, DataType>* graph;
+		int row;
+		int column;
+	};
+
+	using neighbour_range = Range<adjacency_iterator<false>>;
+	using out_edge_range = Range<adjacency_iterator<true>>;
+
 	static inline shared_ptr<GraphAM<IdType, WeightType, DataType>> create_graph(){
 		shared_ptr<GraphAM<IdType, WeightType, DataType>> p = make_shared<GraphAM<IdType, WeightType, DataType>>();
 		return p;
 	}
 
+	/* The wrappers are destroyed in place, their slabs go with the slab array */
 	~GraphAM(){
-		for(auto wrap_map_entry : wrapper_map){
-			delete wrap_map_entry.second;
+		for(auto wrapper_p : wrapper_map){
+			if(wrapper_p == nullptr) continue;
+			wrappers.destroy(wrapper_p->internal_id);
 		}
 	}
 
 	// /* Checks if the node is in the graph */
 	inline bool has_node(const shared_ptr<Node<IdType, DataType>> x){
-		return node_in_graph(x);
+		return find_wrapper_p(x) != nullptr;
+	}
+
+	/*! The fingerprint of the nodes and edges of the graph, see node_fingerprint. It is kept up to
+	date by every change, so reading it is free. Equal graphs have equal fingerprints */
+	inline uint64_t fingerprint() const {
+		return content_fingerprint;
+	}
+
+	/*! Number of nodes in the graph */
+	inline int num_nodes() const {
+		return id_map.size();
 	}
 
 
 	bool has_edge(const shared_ptr<Node<IdType, DataType>> src, const WeightType w, 
 		const shared_ptr<Node<IdType, DataType>> dst){
 
-		/* First we need to check if the nodes are in the graph */
-		if(!nodes_in_graph(src, dst)){
+		/* Get hold of the wrappers, if the nodes are in the graph */
+		auto src_p = find_wrapper_p(src);
+		auto dst_p = find_wrapper_p(dst);
+		if(src_p == nullptr || dst_p == nullptr){
 			return false;
 		}
 
-		/* Get hold of the wrappers */
-		auto src_p = get_wrapper_p(src);
-		auto dst_p = get_wrapper_p(dst);
-
 		if(!adjacent(src_p, dst_p)){
 			return false;
 		}
@@ -83,7 +146,11 @@ public:
 		/* Fill in with edges */
 		vector<shared_ptr<Edge<IdType, WeightType, DataType>>> temp;
 
-		auto row = get_wrapper_p(src)->internal_id;
+		auto src_p = find_wrapper_p(src);
+		if(src_p == nullptr)
+			throw std::invalid_argument("node not in the graph");
+
+		auto row = src_p->internal_id;
 
 		/* Get the indices of the entries that are not zero in the table */
 		auto indices = adjacency_matrix.non_zero_entries(row);
@@ -112,15 +179,39 @@ public:
 		return temp;
 	}
 
+	/* Same as edges_of_node, as EdgeRefs to the nodes held by the graph instead of new Edges */
+	vector<EdgeRef<IdType, WeightType, DataType>> edge_refs_of_node(const shared_ptr<Node<IdType, DataType>> src){
+
+		auto src_p = find_wrapper_p(src);
+		if(src_p == nullptr)
+			throw std::invalid_argument("node not in the graph");
+
+		vector<EdgeRef<IdType, WeightType, DataType>> temp;
+		append_edge_refs(src_p->internal_id, temp);
+		return temp;
+	}
+
+	/* Same as get_edges, as EdgeRefs */
+	vector<EdgeRef<IdType, WeightType, DataType>> edge_refs(){
+		vector<EdgeRef<IdType, WeightType, DataType>> temp;
+		for(int row = 0; row < (int) wrapper_map.size(); ++row){
+			if(wrapper_map[row] != nullptr)
+				append_edge_refs(row, temp);
+		}
+		return temp;
+	}
+
 	/* Returns an edge between two nodes in a graph, if such exists. Throws exp otherwise */
 	shared_ptr<Edge<IdType, WeightType, DataType>> get_edge(shared_ptr<Node<IdType, DataType>> src,
 		shared_ptr<Node<IdType, DataType>> dst){
 		
-		if(!this->adjacent(src, dst))
-			throw std::invalid_argument("edge does not exist");
+		auto src_p = find_wrapper_p(src);
+		auto dst_p = find_wrapper_p(dst);
+		if(src_p == nullptr || dst_p == nullptr)
+			throw std::invalid_argument("src or dst of the edge not in the graph");
 
-		auto src_p = get_wrapper_p(src);
-		auto dst_p = get_wrapper_p(dst);
+		if(!adjacent(src_p, dst_p))
+			throw std::invalid_argument("edge does not exist");
 
 		auto weight = adjacency_matrix.get_entry(src_p->internal_id, dst_p->internal_id);
 		return create_edge(src, weight, dst);
@@ -129,8 +220,9 @@ public:
 	/* Returns the nodes of the graph */
 	vector<shared_ptr<Node<IdType, DataType>>> get_nodes(){
 		vector<shared_ptr<Node<IdType, DataType>>> temp;
-		for(auto wrap_map_entry : wrapper_map){
-			temp.push_back(wrap_map_entry.second->user_node_p);
+		for(auto wrapper_p : wrapper_map){
+			if(wrapper_p == nullptr) continue;
+			temp.push_back(wrapper_p->user_node_p);
 		}
 		return temp;
 	}
@@ -138,8 +230,12 @@ public:
 	/* Function return the neighbours of the node */
 	vector<shared_ptr<Node<IdType, DataType>>> neighbours(const shared_ptr<Node<IdType, DataType>> src){
 
+		auto src_p = find_wrapper_p(src);
+		if(src_p == nullptr)
+			throw std::invalid_argument("node not in the graph");
+
 		/* Get the indices of the entries that are not zero in the table */
-		auto indices = adjacency_matrix.non_zero_entries(get_wrapper_p(src)->internal_id);
+		auto indices = adjacency_matrix.non_zero_entries(src_p->internal_id);
 		vector<shared_ptr<Node<IdType, DataType>>> temp;
 
 		/* For each of these indices, get hold of the Node associated with them */
@@ -150,73 +246,101 @@ public:
 		return temp;
 	}
 
+	/* Same as neighbours, but walks the row of the matrix in place instead of collecting it */
+	neighbour_range neighbours_view(const shared_ptr<Node<IdType, DataType>>& src){
+		return row_range<neighbour_range>(src);
+	}
+
+	/* Walks the outgoing edges of the node in place, as (dst, weight) pairs */
+	out_edge_range out_edges(const shared_ptr<Node<IdType, DataType>>& src){
+		return row_range<out_edge_range>(src);
+	}
+
 	/* Checks if exists a directed edge from src to dst */
 	bool adjacent(const shared_ptr<Node<IdType, DataType>> src, const shared_ptr<Node<IdType, DataType>> dst){
 
-		/* First we need to check if the nodes are in the graph */
-		if(!nodes_in_graph(src, dst)){
+		/* Get hold of the wrappers, if the nodes are in the graph */
+		auto src_p = find_wrapper_p(src);
+		auto dst_p = find_wrapper_p(dst);
+		if(src_p == nullptr || dst_p == nullptr){
 			throw std::invalid_argument("src or dst of the edge not in the graph");
 		}
 
-		/* Get hold of the wrappers */
-		auto src_p = get_wrapper_p(src);
-		auto dst_p = get_wrapper_p(dst);
-
 		return adjacent(src_p, dst_p);
 	}
 
 	/* Adds a node to the graph */
 	bool add_node(const shared_ptr<Node<IdType, DataType>> x){
 
-		/* Check if the vertex is already in the graph */
-		if(node_in_graph(x)){
+		/* Check if the vertex is already in the graph. The slot found here
+		is where the new mapping goes, so the map is probed only once */
+		auto& slot = id_map[x->get_id()];
+		if(slot != nullptr){
 			throw std::invalid_argument("node already added");
 		}
 
-		/* Create the wrapper and add it to adjacency list */
-		NodeAM<IdType, WeightType, DataType>* vertex_p = 
-			new NodeAM<IdType, WeightType, DataType>(this, x);
-		int internal_id = vertex_p->internal_id;
-
-		/* Add the entry to the wrapper map */
-		wrapper_map[internal_id] = vertex_p;
+		emplace_node(x, slot);
+		return true;
+	}
 
-		/* Update the knowledge about highest active id */
-		if(internal_id > highest_active_id){
-			highest_active_id = internal_id;
-			adjacency_matrix.inc_used();
+	/* Adds all the nodes of the batch. The batch is validated first: if one of the nodes is
+	already in the graph, or appears twice, an exception is thrown and nothing is added. The
+	matrix is grown once, to the final size */
+	bool add_nodes(const vector<shared_ptr<Node<IdType, DataType>>>& xs){
+
+		FlatHashMap<IdType, bool> batch;
+		batch.reserve(xs.size());
+		for(auto& x : xs){
+			bool& seen = batch[x->get_id()];
+			if(seen || find_wrapper_p(x) != nullptr){
+				throw std::invalid_argument("node already added");
+			}
+			seen = true;
 		}
 
-		/* Check if our adjacency matrix needs resizing */
-		if(adjacency_matrix.full())
-			adjacency_matrix.resize();
+		/* Recycled ids are handed out first, only the rest extend the matrix */
+		long fresh = max(0l, (long) xs.size() - (long) free_ids.size());
+		adjacency_matrix.reserve(next_unique_id + fresh + 1);
+		wrapper_map.reserve(next_unique_id + fresh);
+		wrappers.reserve(next_unique_id + fresh);
+		id_map.reserve(id_map.size() + xs.size());
 
-		/* Add the new mapping into the map */
-		id_map[x->get_id()] = vertex_p;
-		assert(id_map.find(x->get_id())->second == vertex_p); //ASSERT
+		for(auto& x : xs){
+			emplace_node(x, id_map[x->get_id()]);
+		}
 		return true;
-
 	}
 
 	/* Removes a node from a graph */
 	bool remove_node(const shared_ptr<Node<IdType, DataType>> x){
 
 		/* Check if the vertex is already in the graph */
-		if(!node_in_graph(x)){
+		auto wrapper_p = find_wrapper_p(x);
+		if(wrapper_p == nullptr){
 			throw std::invalid_argument("node not in the graph");
 		}
 
-		auto wrapper_p = get_wrapper_p(x);
 		int internal_id = wrapper_p->internal_id;
 
+		/* Take the node and its edges, both ways, out of the fingerprint */
+		content_fingerprint -= node_fingerprint(wrapper_p->user_node_p->get_id());
+		for(int column = adjacency_matrix.next_non_zero(internal_id, 0); column < adjacency_matrix.used;
+			column = adjacency_matrix.next_non_zero(internal_id, column + 1)){
+			content_fingerprint -= edge_share(internal_id, column, adjacency_matrix.get_entry(internal_id, column));
+		}
+		for(int row = 0; row < (int) wrapper_map.size(); ++row){
+			if(row == internal_id || wrapper_map[row] == nullptr) continue;
+			content_fingerprint -= edge_share(row, internal_id, adjacency_matrix.get_entry(row, internal_id));
+		}
+
 		/* Erase the row an the column */
 		adjacency_matrix.zero_row(internal_id);
 		adjacency_matrix.zero_column(internal_id);
 
 		/* Delete the entry from the wrapper map */
-		wrapper_map.erase(wrapper_p->internal_id);
-		/* Delete the wrapper */
-		delete wrapper_p;
+		wrapper_map[internal_id] = nullptr;
+		/* Destroy the wrapper, its slot is reused with the id */
+		wrappers.destroy(internal_id);
 
 		/* Get the unique id back for id recycling */
 		return_id(internal_id);
@@ -235,15 +359,13 @@ public:
 	bool add_edge(const shared_ptr<Node<IdType, DataType>> src, const WeightType w, 
 		const shared_ptr<Node<IdType, DataType>> dst){
 
-		/* First we need to check if the nodes are in the graph */
-		if(!nodes_in_graph(src, dst)){
+		/* Get hold of the wrappers, if the nodes are in the graph */
+		auto src_p = find_wrapper_p(src);
+		auto dst_p = find_wrapper_p(dst);
+		if(src_p == nullptr || dst_p == nullptr){
 			throw std::invalid_argument("src or dst of the edge not in the graph");
 		}
 
-		/* Get hold of the wrappers */
-		auto src_p = get_wrapper_p(src);
-		auto dst_p = get_wrapper_p(dst);
-
 		/* Get the entry of the adjacency matrix to access */
 		int row = src_p->internal_id;
 		int column = dst_p->internal_id;
@@ -256,6 +378,56 @@ public:
 
 		/* If does not exist, lets add it by adding the weight */
 		adjacency_matrix.set_entry(row, column, w);
+		content_fingerprint += edge_share(row, column, w);
+
+		return true;
+	}
+
+	/* Adds all the edges of the batch of (src id, weight, dst id) records. The batch is sorted
+	once, repeated records are collapsed and the whole batch is validated before anything is added:
+	if a node is not in the graph, an edge already exists, or the batch holds two weights for one
+	edge, an exception is thrown and the graph is left as it was. Without repeats_allowed, a record
+	repeated with the same weight is refused too. */
+	bool add_edges(const vector<EdgeRecord<IdType, WeightType>>& batch, bool repeats_allowed = true){
+
+		vector<resolved_edge> edges;
+		edges.reserve(batch.size());
+
+		/* Resolve every id once, checking membership on the way */
+		for(auto& record : batch){
+			auto src_pp = id_map.find(record.src);
+			auto dst_pp = id_map.find(record.dst);
+			if(src_pp == nullptr || dst_pp == nullptr){
+				throw std::invalid_argument("src or dst of the edge not in the graph");
+			}
+			edges.push_back(resolved_edge{(int) (*src_pp)->internal_id, (int) (*dst_pp)->internal_id, record.weight});
+		}
+
+		/* Sorting by row and column walks the matrix in order, and puts repeated records next to each other */
+		sort(edges.begin(), edges.end(), [](const resolved_edge& a, const resolved_edge& b){
+			if(a.row != b.row)
+				return a.row < b.row;
+			return a.column < b.column;
+		});
+
+		for(size_t i = 0; i < edges.size(); ++i){
+			if(i > 0 && edges[i - 1].row == edges[i].row && edges[i - 1].column == edges[i].column){
+				if(!repeats_allowed || edges[i - 1].w != edges[i].w){
+					throw std::invalid_argument("edge already exists");
+				}
+				continue;
+			}
+			if(adjacency_matrix.get_entry(edges[i].row, edges[i].column) != 0){
+				throw std::invalid_argument("edge already exists");
+			}
+		}
+
+		/* Everything is valid, write the entries */
+		for(size_t i = 0; i < edges.size(); ++i){
+			if(i > 0 && edges[i - 1].row == edges[i].row && edges[i - 1].column == edges[i].column) continue;
+			adjacency_matrix.set_entry(edges[i].row, edges[i].column, edges[i].w);
+			content_fingerprint += edge_share(edges[i].row, edges[i].column, edges[i].w);
+		}
 
 		return true;
 	}
@@ -264,15 +436,13 @@ public:
 	bool remove_edge(const shared_ptr<Node<IdType, DataType>> src,
 		const shared_ptr<Node<IdType, DataType>> dst){
 
-		/* First we need to check if the nodes are in the graph */
-		if(!nodes_in_graph(src, dst)){
+		/* Get hold of the wrappers, if the nodes are in the graph */
+		auto src_p = find_wrapper_p(src);
+		auto dst_p = find_wrapper_p(dst);
+		if(src_p == nullptr || dst_p == nullptr){
 			throw std::invalid_argument("src or dst of the edge not in the graph");
 		}
 
-		/* Get hold of the wrappers */
-		auto src_p = get_wrapper_p(src);
-		auto dst_p = get_wrapper_p(dst);
-
 		/* Get the entry of the adjacency matrix to access */
 		int row = src_p->internal_id;
 		int column = dst_p->internal_id;
@@ -283,18 +453,59 @@ public:
 			throw std::invalid_argument("nodes not adjacent");
 		}
 
-		/* If does not exist, lets add it by adding the weight */
+		content_fingerprint -= edge_share(row, column, adjacency_matrix.get_entry(row, column));
 		adjacency_matrix.zero_entry(row, column);
 
+		return true;
 	}
 
 	void print_graph(){
 		adjacency_matrix.print_matrix();
 	}
 
+	/* The rows of the adjacency matrix, for the algorithms that copy it as a whole. Rows are
+	indexed by internal id, and a row is in use if node_of_row has a node for it. An entry of 0
+	means no edge. Unweighted graphs keep their matrix as bits and have no rows to copy */
+	inline int matrix_rows() const {
+		return wrapper_map.size();
+	}
+
+	inline const WeightType * matrix_row(int row) const requires (!is_same<WeightType, bool>::value) {
+		return adjacency_matrix.entry + (size_t) row * adjacency_matrix.alloced;
+	}
+
+	inline shared_ptr<Node<IdType, DataType>> node_of_row(int row) const {
+		return wrapper_map[row] == nullptr ? nullptr : wrapper_map[row]->user_node_p;
+	}
+
+	/*! Returns a copy of the graph that shares its Nodes. The matrix is copied in one piece and
+	every wrapper goes to the same internal id, so nothing is looked up or validated again */
+	shared_ptr<GraphAM<IdType, WeightType, DataType>> clone(){
+
+		auto copy = create_graph();
+		copy->adjacency_matrix = adjacency_matrix;
+		copy->next_unique_id = next_unique_id;
+		copy->free_ids = free_ids;
+		copy->highest_active_id = highest_active_id;
+		copy->content_fingerprint = content_fingerprint;
+
+		copy->wrapper_map.assign(wrapper_map.size(), nullptr);
+		copy->wrappers.reserve(wrapper_map.size());
+		copy->id_map.reserve(id_map.size());
+		for(auto wrapper_p : wrapper_map){
+			if(wrapper_p == nullptr) continue;
+			auto copy_p = copy->wrappers.emplace(wrapper_p->internal_id, wrapper_p->internal_id, wrapper_p->user_node_p);
+			copy->wrapper_map[wrapper_p->internal_id] = copy_p;
+			copy->id_map[wrapper_p->user_node_p->get_id()] = copy_p;
+		}
+		return copy;
+	}
+
 	/* Need to add more constructors such as list initialization here*/
 	GraphAM(){
 		next_unique_id = 0;
+		highest_active_id = -1;
+		content_fingerprint = 0;
 		//adjacency_matrix = SquareMatrix<WeightType>();
 	}
 
@@ -306,10 +517,17 @@ private:
 	SquareMatrix<WeightType> adjacency_matrix;
 
 	/* Node id to the wrapper */
-	map<IdType, NodeAM<IdType, WeightType, DataType>*> id_map;
+	FlatHashMap<IdType, NodeAM<IdType, WeightType, DataType>*> id_map;
 
-	/* From internal id to the wrapper */
-	map<int, NodeAM<IdType, WeightType, DataType>*> wrapper_map;
+	/* See fingerprint */
+	uint64_t content_fingerprint;
+
+	/* From internal id to the wrapper. Internal ids are dense, so this is a plain
+	vector with nullptr in the slots of removed nodes */
+	vector<NodeAM<IdType, WeightType, DataType>*> wrapper_map;
+
+	/* The wrappers themselves, in the slot of their internal id */
+	SlabArray<NodeAM<IdType, WeightType, DataType>> wrappers;
 
 	/* Same idea as for GraphAl here */
 	long next_unique_id;
@@ -328,25 +546,86 @@ private:
 		}
 	}
 
-	inline bool return_id(int internal_id){
+	inline void return_id(int internal_id){
 		free_ids.push_back(internal_id);
 	}
 
-	inline bool node_in_graph(const shared_ptr<Node<IdType, DataType>> x){
-		if(id_map.find(x->get_id()) != id_map.end()){
-			return true;
+	/* An edge of a batch, with its nodes already turned into matrix coordinates */
+	struct resolved_edge{
+		int row;
+		int column;
+		WeightType w;
+	};
+
+	/* Creates the wrapper of x, grows the matrix if needed and stores the wrapper in slot,
+	the entry of id_map for x. Assumes x is not in the graph yet */
+	void emplace_node(const shared_ptr<Node<IdType, DataType>>& x,
+		NodeAM<IdType, WeightType, DataType>*& slot){
+
+		int internal_id = get_new_id();
+		NodeAM<IdType, WeightType, DataType>* vertex_p = wrappers.emplace(internal_id, internal_id, x);
+
+		/* Add the entry to the wrapper map */
+		if(internal_id == (int) wrapper_map.size()){
+			wrapper_map.push_back(vertex_p);
+		}else{
+			wrapper_map[internal_id] = vertex_p;
+		}
+		content_fingerprint += node_fingerprint(x->get_id());
+
+		/* Update the knowledge about highest active id */
+		if(internal_id > highest_active_id){
+			highest_active_id = internal_id;
+			adjacency_matrix.inc_used();
+		}
+
+		/* Check if our adjacency matrix needs resizing */
+		if(adjacency_matrix.full())
+			adjacency_matrix.resize();
+
+		/* Add the new mapping into the map */
+		slot = vertex_p;
+		assert(*id_map.find(x->get_id()) == vertex_p); //ASSERT
+	}
+
+	/* Returns the wrapper of x, or nullptr if x is not in the graph. The membership
+	check and the lookup are the same probe of id_map */
+	inline NodeAM<IdType, WeightType, DataType>* find_wrapper_p(const shared_ptr<Node<IdType, DataType>>& x){
+		auto wrapper_pp = id_map.find(x->get_id());
+		if(wrapper_pp == nullptr){
+			return nullptr;
 		}
-		return false;
+		return *wrapper_pp;
 	}
 
-	inline bool nodes_in_graph(const shared_ptr<Node<IdType, DataType>> x,
-		const shared_ptr<Node<IdType, DataType>> y){
-		return (node_in_graph(x) && node_in_graph(y));
+	/* The share of the entry in the fingerprint. A zero entry is no edge */
+	inline uint64_t edge_share(int row, int column, const WeightType w){
+		if(w == 0)
+			return 0;
+		return edge_fingerprint(wrapper_map[row]->user_node_p->get_id(), w, wrapper_map[column]->user_node_p->get_id());
 	}
 
-	/* NOTE: Assumes x is in the graph */
-	NodeAM<IdType, WeightType, DataType>* get_wrapper_p(const shared_ptr<Node<IdType, DataType>> x){
-		return id_map.find(x->get_id())->second;
+	/* Appends an EdgeRef for every non zero entry of the row */
+	void append_edge_refs(int row, vector<EdgeRef<IdType, WeightType, DataType>>& refs){
+		auto& src_p = wrapper_map[row]->user_node_p;
+		for(int column = adjacency_matrix.next_non_zero(row, 0); column < adjacency_matrix.used;
+			column = adjacency_matrix.next_non_zero(row, column + 1)){
+			refs.push_back({&src_p, &wrapper_map[column]->user_node_p, adjacency_matrix.get_entry(row, column)});
+		}
+	}
+
+	/* Builds a range over the row of src */
+	template <typename RangeType>
+	RangeType row_range(const shared_ptr<Node<IdType, DataType>>& src){
+
+		auto src_p = find_wrapper_p(src);
+		if(src_p == nullptr)
+			throw std::invalid_argument("node not in the graph");
+
+		int row = src_p->internal_id;
+		return RangeType(
+			typename RangeType::iterator(this, row, adjacency_matrix.next_non_zero(row, 0)),
+			typename RangeType::iterator(this, row, adjacency_matrix.used));
 	}
 
 	bool adjacent(const NodeAM<IdType, WeightType, DataType> * src_p, 
@@ -367,15 +646,13 @@ what represents a Node in a given graph.  */
 template <typename IdType, typename WeightType, typename DataType>
 class NodeAM{
 friend class GraphAM<IdType, WeightType, DataType>;
+friend class GraphCSR<IdType, WeightType, DataType>;
 public:
 
-	/* Need to think about other constructors here a little */
-	/* Existance of NodeAL only maks sense in the context of a graph */
-	NodeAM(GraphAM<IdType, WeightType, DataType>* graph,
-		const shared_ptr<Node<IdType, DataType>> user_node){
-		/* Get the new internal id */
-		internal_id = graph->get_new_id();
-
+	/* Existance of NodeAM only maks sense in the context of a graph, which hands out the
+	internal id and the memory */
+	NodeAM(long internal_id, const shared_ptr<Node<IdType, DataType>> user_node){
+		this->internal_id = internal_id;
 		user_node_p = user_node;
 	}
 
@@ -0,0 +1,501 @@
+#ifndef GRAPH_CSR_H
+#define GRAPH_CSR_H
+
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <map>
+#include <assert.h>
+#include <stdexcept>
+#include <utility>
+#include <type_traits>
+
+#include "graph_concepts.h"
+#include "gcore.h"
+#include "views.h"
+#include "FlatHashMap.h"
+
+
+using namespace std;
+
+template <typename IdType, typename WeightType, typename DataType>
+requires Comparable<IdType> && Numeric<WeightType>
+class GraphAL;
+template <typename IdType, typename WeightType, typename DataType>
+class GraphAM;
+
+
+/************************* GraphCSR Class ****************************/
+/*! This class provides the compressed sparse row implementation of a Graph. A GraphCSR is an
+immutable snapshot, frozen from a GraphAL or a GraphAM, that stores the whole adjacency structure
+in three contiguous arrays: the offsets of the rows, the targets and the weights of the edges.
+Use this implementation for read-heavy workloads on graphs that do not change once built. Nodes
+are numbered densely from 0 to num_nodes() - 1 and the targets of every row are kept sorted, so
+adjacency checks are a binary search. */
+template <typename IdType, typename WeightType, typename DataType>
+requires Comparable<IdType> && Numeric<WeightType>
+class GraphCSR{
+public:
+
+	using id_type = IdType;
+	using weight_type = WeightType;
+	using data_type = DataType;
+
+	/*! Iterates a row of the snapshot in place. Yields the neighbouring Node, or the
+	(Node, weight) pair when WithWeight is set */
+	template <bool WithWeight>
+	class adjacency_iterator{
+	public:
+		using value_type = typename conditional<WithWeight,
+			pair<const shared_ptr<Node<IdType, DataType>>&, WeightType>,
+			const shared_ptr<Node<IdType, DataType>>&>::type;
+
+		adjacency_iterator(const GraphCSR<IdType, WeightType, DataType>* graph, const int * ends,
+			const WeightType * weights, size_t position)
+			: graph(graph), ends(ends), weights(weights), position(position) {}
+
+		inline value_type operator*() const {
+			auto& node_p = graph->nodes[ends[position]];
+			if constexpr (WithWeight){
+				return value_type(node_p, weights[position]);
+			}else{
+				return node_p;
+			}
+		}
+
+		inline adjacency_iterator& operator++(){
+			++position;
+			return *this;
+		}
+
+		inline bool operator==(const adjacency_iterator& rhs) const {
+			return position == rhs.position;
+		}
+
+		inline bool operator!=(const adjacency_iterator& rhs) const {
+			return position != rhs.position;
+		}
+
+	private:
+		const GraphCSR<IdType, WeightType, DataType>* graph;
+		/* The other end and the weight of every edge, of either the out or the in arrays */
+		const int * ends;
+		const WeightType * weights;
+		size_t position;
+	};
+
+	using neighbour_range = Range<adjacency_iterator<false>>;
+	using out_edge_range = Range<adjacency_iterator<true>>;
+
+	/*! Freezes an adjacency list graph into a new snapshot. With with_in_edges set the snapshot
+	also stores the transposed arrays, see has_in_edges */
+	static inline shared_ptr<GraphCSR<IdType, WeightType, DataType>> create_graph(
+		GraphAL<IdType, WeightType, DataType>& g, bool with_in_edges = false){
+
+		shared_ptr<GraphCSR<IdType, WeightType, DataType>> p = make_shared<GraphCSR<IdType, WeightType, DataType>>();
+		p->build_from(g);
+		if(with_in_edges)
+			p->build_in_edges();
+		return p;
+	}
+
+	/*! Freezes an adjacency matrix graph into a new snapshot. With with_in_edges set the snapshot
+	also stores the transposed arrays, see has_in_edges */
+	static inline shared_ptr<GraphCSR<IdType, WeightType, DataType>> create_graph(
+		GraphAM<IdType, WeightType, DataType>& g, bool with_in_edges = false){
+
+		shared_ptr<GraphCSR<IdType, WeightType, DataType>> p = make_shared<GraphCSR<IdType, WeightType, DataType>>();
+		p->build_from(g);
+		if(with_in_edges)
+			p->build_in_edges();
+		return p;
+	}
+
+	/* Checks if the node is in the graph */
+	inline bool has_node(const shared_ptr<Node<IdType, DataType>> x){
+		return find_index(x) != -1;
+	}
+
+	bool has_edge(const shared_ptr<Node<IdType, DataType>> src, const WeightType w,
+		const shared_ptr<Node<IdType, DataType>> dst){
+
+		int src_i = find_index(src);
+		int dst_i = find_index(dst);
+		if(src_i == -1 || dst_i == -1){
+			return false;
+		}
+
+		long position = edge_position(src_i, dst_i);
+		if(position == -1){
+			return false;
+		}
+
+		return weights[position] == w;
+	}
+
+	/* Returns all the outgoing edges from a given node */
+	vector<shared_ptr<Edge<IdType, WeightType, DataType>>> edges_of_node(const shared_ptr<Node<IdType, DataType>> x){
+
+		int row = find_index(x);
+		if(row == -1)
+			throw std::invalid_argument("node not in the graph");
+
+		vector<shared_ptr<Edge<IdType, WeightType, DataType>>> temp;
+		temp.reserve(offsets[row + 1] - offsets[row]);
+
+		for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+			temp.push_back(create_edge(nodes[row], weights[i], nodes[targets[i]]));
+		}
+
+		return temp;
+	}
+
+	/* Returns a vector of all eges in the graph */
+	vector<shared_ptr<Edge<IdType, WeightType, DataType>>> get_edges(){
+
+		vector<shared_ptr<Edge<IdType, WeightType, DataType>>> temp;
+		temp.reserve(targets.size());
+
+		for(int row = 0; row < num_nodes(); ++row){
+			for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+				temp.push_back(create_edge(nodes[row], weights[i], nodes[targets[i]]));
+			}
+		}
+
+		return temp;
+	}
+
+	/* Same as edges_of_node, as EdgeRefs to the nodes held by the graph instead of new Edges */
+	vector<EdgeRef<IdType, WeightType, DataType>> edge_refs_of_node(const shared_ptr<Node<IdType, DataType>> x){
+
+		int row = find_index(x);
+		if(row == -1)
+			throw std::invalid_argument("node not in the graph");
+
+		vector<EdgeRef<IdType, WeightType, DataType>> temp;
+		temp.reserve(offsets[row + 1] - offsets[row]);
+		for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+			temp.push_back({&nodes[row], &nodes[targets[i]], weights[i]});
+		}
+		return temp;
+	}
+
+	/* Same as get_edges, as EdgeRefs */
+	vector<EdgeRef<IdType, WeightType, DataType>> edge_refs(){
+
+		vector<EdgeRef<IdType, WeightType, DataType>> temp;
+		temp.reserve(targets.size());
+		for(int row = 0; row < num_nodes(); ++row){
+			for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+				temp.push_back({&nodes[row], &nodes[targets[i]], weights[i]});
+			}
+		}
+		return temp;
+	}
+
+	/* Returns an edge between two nodes in a graph, if such exists. Throws exp otherwise */
+	shared_ptr<Edge<IdType, WeightType, DataType>> get_edge(shared_ptr<Node<IdType, DataType>> src,
+		shared_ptr<Node<IdType, DataType>> dst){
+
+		int src_i = find_index(src);
+		int dst_i = find_index(dst);
+		if(src_i == -1 || dst_i == -1)
+			throw std::invalid_argument("node not in the graph");
+
+		long position = edge_position(src_i, dst_i);
+		if(position == -1)
+			throw std::invalid_argument("edge does not exist");
+
+		return create_edge(src, weights[position], dst);
+	}
+
+	/* Returns the nodes of the graph */
+	vector<shared_ptr<Node<IdType, DataType>>> get_nodes(){
+		return nodes;
+	}
+
+	/* Function return the neighbours of the node */
+	vector<shared_ptr<Node<IdType, DataType>>> neighbours(const shared_ptr<Node<IdType, DataType>> src){
+
+		int row = find_index(src);
+		if(row == -1)
+			throw std::invalid_argument("node not in the graph");
+
+		vector<shared_ptr<Node<IdType, DataType>>> temp;
+		temp.reserve(offsets[row + 1] - offsets[row]);
+
+		for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+			temp.push_back(nodes[targets[i]]);
+		}
+
+		return temp;
+	}
+
+	/* Same as neighbours, but walks the row in place instead of copying it */
+	neighbour_range neighbours_view(const shared_ptr<Node<IdType, DataType>>& src){
+		int row = index_of(src);
+		return neighbour_range(adjacency_iterator<false>(this, targets.data(), weights.data(), offsets[row]),
+			adjacency_iterator<false>(this, targets.data(), weights.data(), offsets[row + 1]));
+	}
+
+	/* Walks the outgoing edges of the node in place, as (dst, weight) pairs */
+	out_edge_range out_edges(const shared_ptr<Node<IdType, DataType>>& src){
+		int row = index_of(src);
+		return out_edge_range(adjacency_iterator<true>(this, targets.data(), weights.data(), offsets[row]),
+			adjacency_iterator<true>(this, targets.data(), weights.data(), offsets[row + 1]));
+	}
+
+	/* Returns the nodes with an edge to dst. Throws if the snapshot was frozen without in-edges */
+	vector<shared_ptr<Node<IdType, DataType>>> predecessors(const shared_ptr<Node<IdType, DataType>> dst){
+
+		vector<shared_ptr<Node<IdType, DataType>>> temp;
+		for(auto edge : in_edges(dst)){
+			temp.push_back(edge.first);
+		}
+		return temp;
+	}
+
+	/* Walks the incoming edges of the node in place, as (src, weight) pairs. Throws if the
+	snapshot was frozen without in-edges */
+	out_edge_range in_edges(const shared_ptr<Node<IdType, DataType>>& dst){
+
+		if(!has_in_edges())
+			throw std::logic_error("in-edges are not tracked");
+
+		int row = index_of(dst);
+		return out_edge_range(adjacency_iterator<true>(this, sources.data(), in_weights.data(), in_offsets[row]),
+			adjacency_iterator<true>(this, sources.data(), in_weights.data(), in_offsets[row + 1]));
+	}
+
+	/* Checks if exists a directed edge from src to dst */
+	bool adjacent(const shared_ptr<Node<IdType, DataType>> src, const shared_ptr<Node<IdType, DataType>> dst){
+
+		int src_i = find_index(src);
+		int dst_i = find_index(dst);
+		if(src_i == -1 || dst_i == -1)
+			throw std::invalid_argument("node not in the graph");
+
+		return edge_position(src_i, dst_i) != -1;
+	}
+
+	/* DENSE ACCESS. Algorithms that work on dense ids use the functions below to walk
+	the contiguous arrays directly. */
+
+	/*! Number of nodes in the snapshot. Dense indices run from 0 to num_nodes() - 1 */
+	inline int num_nodes() const {
+		return nodes.size();
+	}
+
+	/*! Number of edges in the snapshot */
+	inline size_t num_edges() const {
+		return targets.size();
+	}
+
+	/*! Returns the dense index of the node. Throws if the node is not in the graph */
+	inline int index_of(const shared_ptr<Node<IdType, DataType>> x) const {
+		int i = find_index(x);
+		if(i == -1)
+			throw std::invalid_argument("node not in the graph");
+		return i;
+	}
+
+	/*! Returns the node with the given dense index */
+	inline const shared_ptr<Node<IdType, DataType>>& node_at(int i) const {
+		return nodes[i];
+	}
+
+	/*! Edges of the node with dense index i occupy [offset_array()[i], offset_array()[i + 1]) */
+	inline const size_t * offset_array() const {
+		return offsets.data();
+	}
+
+	/*! Dense index of the destination of every edge */
+	inline const int * target_array() const {
+		return targets.data();
+	}
+
+	/*! Weight of every edge */
+	inline const WeightType * weight_array() const {
+		return weights.data();
+	}
+
+	/*! Checks if the snapshot was frozen with in-edges. The in arrays below are the transpose
+	of the out arrays, and are empty without them */
+	inline bool has_in_edges() const {
+		return !in_offsets.empty();
+	}
+
+	/*! Edges into the node with dense index i occupy [in_offset_array()[i], in_offset_array()[i + 1]) */
+	inline const size_t * in_offset_array() const {
+		return in_offsets.data();
+	}
+
+	/*! Dense index of the source of every in-edge, sorted within each node */
+	inline const int * source_array() const {
+		return sources.data();
+	}
+
+	/*! Weight of every in-edge */
+	inline const WeightType * in_weight_array() const {
+		return in_weights.data();
+	}
+
+	void print_graph(){
+		for(int row = 0; row < num_nodes(); ++row){
+			cout << nodes[row]->get_id() << "-> ";
+			for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+				cout << "(" << nodes[targets[i]]->get_id() <<
+				":" << weights[i] << "), ";
+			}
+			cout << endl;
+		}
+	}
+
+	/* Snapshots are only built through create_graph */
+	GraphCSR(){
+		offsets.push_back(0);
+	}
+
+private:
+
+	/* Row i spans [offsets[i], offsets[i + 1]) of targets and weights */
+	vector<size_t> offsets;
+	vector<int> targets;
+	vector<WeightType> weights;
+
+	/* The transpose, built only on request */
+	vector<size_t> in_offsets;
+	vector<int> sources;
+	vector<WeightType> in_weights;
+
+	/* Dense index to the user node, and back */
+	vector<shared_ptr<Node<IdType, DataType>>> nodes;
+	FlatHashMap<IdType, int> index_map;
+
+	/* Returns the dense index of x, or -1 if x is not in the graph */
+	inline int find_index(const shared_ptr<Node<IdType, DataType>> x) const {
+		auto index_p = index_map.find(x->get_id());
+		if(index_p == nullptr)
+			return -1;
+		return *index_p;
+	}
+
+	/* Binary search for dst in the sorted row of src. Returns the position
+	of the edge in targets, or -1 if the nodes are not adjacent */
+	inline long edge_position(int src_i, int dst_i) const {
+		auto first = targets.begin() + offsets[src_i];
+		auto last = targets.begin() + offsets[src_i + 1];
+		auto it = lower_bound(first, last, dst_i);
+		if(it == last || *it != dst_i)
+			return -1;
+		return it - targets.begin();
+	}
+
+	/* Registers the node under the next dense index */
+	inline void push_node(const shared_ptr<Node<IdType, DataType>>& x){
+		index_map[x->get_id()] = nodes.size();
+		nodes.push_back(x);
+	}
+
+	void build_from(GraphAL<IdType, WeightType, DataType>& g){
+
+		/* Internal ids of GraphAL may have holes left by removed nodes,
+		so first compact them into dense indices */
+		vector<int> dense(g.adjacency_list.size(), -1);
+		size_t edge_count = 0;
+		index_map.reserve(g.id_map.size());
+		for(auto wrapper_p : g.adjacency_list){
+			if(wrapper_p == nullptr) continue;
+			dense[wrapper_p->internal_id] = nodes.size();
+			push_node(wrapper_p->user_node_p);
+			edge_count += wrapper_p->neighbours.size();
+		}
+
+		offsets.reserve(nodes.size() + 1);
+		targets.reserve(edge_count);
+		weights.reserve(edge_count);
+
+		/* Copy every neighbour list, sorted by the dense index of the target */
+		vector<pair<int, WeightType>> row;
+		for(auto wrapper_p : g.adjacency_list){
+			if(wrapper_p == nullptr) continue;
+
+			row.clear();
+			for(auto& edge : wrapper_p->neighbours){
+				row.push_back(make_pair(dense[edge.first->internal_id], edge.second));
+			}
+			sort(row.begin(), row.end(),
+				[](const pair<int, WeightType>& a, const pair<int, WeightType>& b)
+					{return a.first < b.first;});
+
+			for(auto& edge : row){
+				targets.push_back(edge.first);
+				weights.push_back(edge.second);
+			}
+			offsets.push_back(targets.size());
+		}
+	}
+
+	/* Builds the transposed arrays from the out arrays with a counting sort on the targets.
+	Rows are visited in order, so the sources of every node come out sorted */
+	void build_in_edges(){
+
+		int n = num_nodes();
+		in_offsets.assign(n + 1, 0);
+		for(auto target : targets){
+			in_offsets[target + 1]++;
+		}
+		for(int i = 0; i < n; ++i){
+			in_offsets[i + 1] += in_offsets[i];
+		}
+
+		sources.resize(targets.size());
+		in_weights.resize(targets.size());
+		vector<size_t> next(in_offsets.begin(), in_offsets.end() - 1);
+		for(int row = 0; row < n; ++row){
+			for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+				size_t slot = next[targets[i]]++;
+				sources[slot] = row;
+				in_weights[slot] = weights[i];
+			}
+		}
+	}
+
+	void build_from(GraphAM<IdType, WeightType, DataType>& g){
+
+		/* wrapper_map is indexed by internal id, so the dense indices
+		preserve the column order of the matrix rows */
+		vector<int> dense(g.wrapper_map.size(), -1);
+		size_t edge_count = 0;
+		index_map.reserve(g.id_map.size());
+		for(auto wrapper_p : g.wrapper_map){
+			if(wrapper_p == nullptr) continue;
+			dense[wrapper_p->internal_id] = nodes.size();
+			push_node(wrapper_p->user_node_p);
+			edge_count += g.adjacency_matrix.non_zero_count(wrapper_p->internal_id);
+		}
+
+		offsets.reserve(nodes.size() + 1);
+		targets.reserve(edge_count);
+		weights.reserve(edge_count);
+		for(auto wrapper_p : g.wrapper_map){
+			if(wrapper_p == nullptr) continue;
+			int row = wrapper_p->internal_id;
+			for(auto column : g.adjacency_matrix.non_zero_entries(row)){
+				targets.push_back(dense[column]);
+				weights.push_back(g.adjacency_matrix.get_entry(row, column));
+			}
+			offsets.push_back(targets.size());
+		}
+	}
+};
+
+/*! Algorithms that build a graph from an immutable GraphCSR build it as a GraphAL */
+template <>
+struct result_graph<GraphCSR>{
+	template <typename I, typename W, typename D>
+	using type = GraphAL<I, W, D>;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef SLAB_ARRAY_H
+#define SLAB_ARRAY_H
+
+/* Objects per slab, as a power of two */
+#define SLAB_BITS 8
+
+/* Slabs start on a cache line, so an object no bigger than a line that divides it never straddles two */
+#define SLAB_ALIGNMENT 64
+
+#include <new>
+#include <vector>
+#include <utility>
+#include <stddef.h>
+
+
+/*! This is a supporting class for the graph implementations. It stores objects by index in
+slabs of 2^SlabBits slots that are allocated once and never move, so the object at an index keeps
+its address and neighbouring indices are neighbours in memory. The graphs index it by the internal
+ids of the nodes, which they recycle, so the slot of a removed node goes to the next one added.
+The slab array does not know which slots hold an object: the owner destroys its objects, and the
+slabs are freed together when the array goes. */
+template <typename T, unsigned SlabBits = SLAB_BITS>
+class SlabArray{
+
+public:
+
+	SlabArray() {}
+
+	SlabArray(const SlabArray&) = delete;
+	void operator=(const SlabArray&) = delete;
+
+	~SlabArray(){
+		for(auto slab : slabs){
+			::operator delete(slab, alignment);
+		}
+	}
+
+	/*! Constructs an object in slot i and returns it. The slot must be empty */
+	template <typename... Args>
+	inline T * emplace(size_t i, Args&&... args){
+		size_t s = i >> SlabBits;
+		while(slabs.size() <= s){
+			slabs.push_back(static_cast<T *>(::operator new(sizeof(T) << SlabBits, alignment)));
+		}
+		return new (slabs[s] + (i & mask)) T(std::forward<Args>(args)...);
+	}
+
+	/*! Destroys the object in slot i, which can then be used again */
+	inline void destroy(size_t i){
+		(*this)[i].~T();
+	}
+
+	inline T& operator[](size_t i){
+		return slabs[i >> SlabBits][i & mask];
+	}
+
+	/*! Allocates the slabs for the slots below n */
+	void reserve(size_t n){
+		while(slabs.size() << SlabBits < n){
+			slabs.push_back(static_cast<T *>(::operator new(sizeof(T) << SlabBits, alignment)));
+		}
+	}
+
+private:
+	static const size_t mask = (size_t(1) << SlabBits) - 1;
+	static constexpr std::align_val_t alignment{alignof(T) > SLAB_ALIGNMENT ? alignof(T) : SLAB_ALIGNMENT};
+	std::vector<T *> slabs;
+
+};
+#endif
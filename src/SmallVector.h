@@ -0,0 +1,184 @@
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <new>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <stddef.h>
+
+
+/*! This is a supporting class for the graph implementations. It is a vector that keeps its
+first N elements inside the object and only goes to the heap when it grows past them, so the
+short neighbour lists of most nodes cost no allocation and sit next to the rest of the node.
+The inline elements share their space with the heap pointer, so the object is only a count and
+a capacity bigger than its elements. Iterators are plain pointers, and are invalidated like the
+ones of std::vector. */
+template <typename T, unsigned N>
+class SmallVector{
+
+	static_assert(N > 0, "SmallVector needs room for at least one inline element");
+
+public:
+
+	using value_type = T;
+	using iterator = T *;
+	using const_iterator = const T *;
+
+	SmallVector(){
+		count = 0;
+		capacity = N;
+	}
+
+	SmallVector(const SmallVector& other) : SmallVector() {
+		reserve(other.size());
+		std::uninitialized_copy(other.begin(), other.end(), data());
+		count = other.count;
+	}
+
+	SmallVector(SmallVector&& other) : SmallVector() {
+		take(other);
+	}
+
+	SmallVector& operator=(const SmallVector& other){
+		if(this != &other){
+			clear();
+			reserve(other.size());
+			std::uninitialized_copy(other.begin(), other.end(), data());
+			count = other.count;
+		}
+		return *this;
+	}
+
+	SmallVector& operator=(SmallVector&& other){
+		if(this != &other){
+			clear();
+			release();
+			take(other);
+		}
+		return *this;
+	}
+
+	~SmallVector(){
+		clear();
+		release();
+	}
+
+	inline T * data(){ return is_inline() ? inline_elements() : heap; }
+	inline const T * data() const { return is_inline() ? inline_elements() : heap; }
+
+	inline iterator begin(){ return data(); }
+	inline iterator end(){ return data() + count; }
+	inline const_iterator begin() const { return data(); }
+	inline const_iterator end() const { return data() + count; }
+	inline const_iterator cbegin() const { return data(); }
+	inline const_iterator cend() const { return data() + count; }
+
+	inline size_t size() const {
+		return count;
+	}
+
+	inline bool empty() const {
+		return count == 0;
+	}
+
+	/*! Checks if the elements are still kept inside the object. Heap memory is always bigger
+	than the inline room, so the capacity tells */
+	inline bool is_inline() const {
+		return capacity == N;
+	}
+
+	inline T& operator[](size_t i){ return data()[i]; }
+	inline const T& operator[](size_t i) const { return data()[i]; }
+	inline T& back(){ return data()[count - 1]; }
+	inline const T& back() const { return data()[count - 1]; }
+
+	/*! Makes room for n elements */
+	void reserve(size_t n){
+		if(n <= capacity)
+			return;
+
+		T * moved = static_cast<T *>(::operator new(n * sizeof(T)));
+		std::uninitialized_move(begin(), end(), moved);
+		std::destroy(begin(), end());
+		release();
+		heap = moved;
+		capacity = n;
+	}
+
+	void push_back(const T& x){
+		if(count == capacity)
+			reserve(2 * capacity);
+		new (data() + count) T(x);
+		++count;
+	}
+
+	void pop_back(){
+		--count;
+		data()[count].~T();
+	}
+
+	/*! Inserts x before position, shifting the following elements up */
+	iterator insert(const_iterator position, const T& x){
+		size_t i = position - begin();
+		push_back(x);
+		std::rotate(begin() + i, end() - 1, end());
+		return begin() + i;
+	}
+
+	/*! Erases the element at position, shifting the following elements down */
+	iterator erase(const_iterator position){
+		size_t i = position - begin();
+		std::move(begin() + i + 1, end(), begin() + i);
+		pop_back();
+		return begin() + i;
+	}
+
+	/*! Destroys the elements. Memory taken from the heap is kept */
+	void clear(){
+		std::destroy(begin(), end());
+		count = 0;
+	}
+
+private:
+	unsigned count;
+	unsigned capacity;
+
+	/* The elements, inline while they fit */
+	union{
+		T * heap;
+		alignas(T) unsigned char buffer[N * sizeof(T)];
+	};
+
+	inline T * inline_elements(){
+		return reinterpret_cast<T *>(buffer);
+	}
+
+	inline const T * inline_elements() const {
+		return reinterpret_cast<const T *>(buffer);
+	}
+
+	/* Frees the heap memory and goes back to the inline elements. Assumes there are no elements */
+	void release(){
+		if(!is_inline())
+			::operator delete(heap);
+		capacity = N;
+	}
+
+	/* Takes the elements of other, which is left empty. Assumes there are no elements here */
+	void take(SmallVector& other){
+		if(other.is_inline()){
+			std::uninitialized_move(other.begin(), other.end(), inline_elements());
+			count = other.count;
+			other.clear();
+		}else{
+			heap = other.heap;
+			count = other.count;
+			capacity = other.capacity;
+			other.count = 0;
+			other.capacity = N;
+		}
+	}
+
+};
+#endif
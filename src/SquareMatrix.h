@@ -5,10 +5,38 @@
 #define FIRST_ALLOC 4
 
 #include <stdexcept>
+#include <algorithm>
 #include <iostream>
 #include <string.h>
+#include <stdint.h>
 #include <vector>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SCAN_BLOCK 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SCAN_BLOCK 16
+#else
+#define SCAN_BLOCK 8
+#endif
+
+/*! Checks if SCAN_BLOCK bytes starting at p are all zero. Uses AVX2 or SSE2 when the
+target has them, and a 64-bit word compare otherwise. */
+static inline bool is_zero_block(const unsigned char * p){
+#if defined(__AVX2__)
+	__m256i v = _mm256_loadu_si256((const __m256i *) p);
+	return _mm256_testz_si256(v, v);
+#elif defined(__SSE2__)
+	__m128i v = _mm_loadu_si128((const __m128i *) p);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xFFFF;
+#else
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v == 0;
+#endif
+}
+
 
 /*! This is a supporting class for adjacency matrix implementation. It provides
 a simple square matrix interface, which is exactly what is needed in GraphAM. */
@@ -20,31 +48,62 @@ public:
 	int used;
 	int alloced;
 
+	/* Number of non zero entries in every row, so empty rows are skipped without a scan */
+	std::vector<int> row_non_zero;
+
 	SquareMatrix(){
 		used = 0;
 		alloced = FIRST_ALLOC;
 		entry = new EntryType[alloced * alloced];
 		memset(entry, 0, sizeof(EntryType) * alloced * alloced);
+		row_non_zero.assign(alloced, 0);
+	}
+
+	/*! Copies the matrix with one allocation and one bulk copy of the entries */
+	SquareMatrix(const SquareMatrix& other){
+		entry = nullptr;
+		copy_from(other);
+	}
+
+	SquareMatrix& operator=(const SquareMatrix& other){
+		if(this != &other)
+			copy_from(other);
+		return *this;
 	}
 
 	~SquareMatrix(){
 		delete[] entry;
 	}
 
+	void copy_from(const SquareMatrix& other){
+		auto new_entry = new EntryType[other.alloced * other.alloced];
+		memcpy(new_entry, other.entry, sizeof(EntryType) * other.alloced * other.alloced);
+		delete[] entry;
+		entry = new_entry;
+		used = other.used;
+		alloced = other.alloced;
+		row_non_zero = other.row_non_zero;
+	}
+
 	void resize(){
+		resize_to(alloced * GROW_FACTOR);
+	}
+
+	/* Grows the matrix in one step, so that it has room for size rows and columns */
+	void reserve(int size){
+		if(size > alloced)
+			resize_to(size);
+	}
 
-		/* Determine the square size of new matrix */
-		int new_alloced = alloced * GROW_FACTOR;
+	void resize_to(int new_alloced){
 
 		/* Get an empty array of bigger size */
 		auto new_entry = new EntryType[new_alloced * new_alloced];
 		memset(new_entry, 0, sizeof(EntryType) * new_alloced * new_alloced);
 
-		/* Copy the contents of old matrix */
+		/* Copy the contents of old matrix, a row at a time */
 		for(int i = 0; i < used; i++){
-			for(int j = 0; j < used; j++){
-				*(new_entry + i*new_alloced + j) = (*(entry + i*alloced + j));
-			}
+			memcpy(new_entry + i*new_alloced, entry + i*alloced, sizeof(EntryType) * used);
 		}
 
 		/* Delete the old matrix */
@@ -53,6 +112,7 @@ public:
 		/* Assign the new matrix to entry */
 		entry = new_entry;
 		alloced = new_alloced;
+		row_non_zero.resize(alloced, 0);
 	}
 
 	inline EntryType get_entry(int row_index, int column_index){
@@ -60,11 +120,16 @@ public:
 	}
 
 	inline void set_entry(int row_index, int column_index, EntryType value){
+		bool was_zero = is_zero_entry(row_index, column_index);
 		(*(entry + row_index*alloced + column_index)) = value;
+		row_non_zero[row_index] += was_zero - is_zero_entry(row_index, column_index);
 	}
 
 	inline void zero_entry(int row_index, int column_index){
+		if(is_zero_entry(row_index, column_index))
+			return;
 		memset(entry + row_index*alloced + column_index, 0, sizeof(EntryType));
+		row_non_zero[row_index]--;
 	}
 
 	inline bool is_zero_entry(int row_index, int column_index){
@@ -81,21 +146,83 @@ public:
 	inline std::vector<int> non_zero_entries(int row_index){
 		vector<int> temp;
 
-		/* Walk through the row and find the nonzero entries */
-		for(int i = 0; i < alloced; ++i){
-			if(!is_zero_entry(row_index, i)){
-				temp.push_back(i);
+		int remaining = row_non_zero[row_index];
+		if(remaining == 0)
+			return temp;
+		temp.reserve(remaining);
+
+		/* Only the first used columns can be non zero. Skip the zero blocks of the row
+		a vector at a time, and only look at the entries of the blocks that have a set byte.
+		The scan stops as soon as all non zero entries of the row have been found. */
+		const unsigned char * bytes = (const unsigned char *) (entry + row_index*alloced);
+		size_t length = sizeof(EntryType) * used;
+		int column = 0;
+
+		for(size_t block = 0; block + SCAN_BLOCK <= length; block += SCAN_BLOCK){
+			if(is_zero_block(bytes + block))
+				continue;
+
+			/* Entries overlapping this block, skipping the ones already checked */
+			int first = std::max(column, (int) (block / sizeof(EntryType)));
+			int last = (block + SCAN_BLOCK - 1) / sizeof(EntryType);
+			for(column = first; column <= last; ++column){
+				if(!is_zero_entry(row_index, column)){
+					temp.push_back(column);
+					if(--remaining == 0)
+						return temp;
+				}
+			}
+		}
+
+		/* Tail of the row that does not fill a whole block */
+		column = std::max(column, (int) ((length / SCAN_BLOCK) * SCAN_BLOCK / sizeof(EntryType)));
+		for(; column < used; ++column){
+			if(!is_zero_entry(row_index, column)){
+				temp.push_back(column);
+				if(--remaining == 0)
+					return temp;
 			}
 		}
 		return temp;
 	}
 
+	/* Returns the first non zero column of the row at or after column, or used if there is none.
+	Zero blocks are skipped the same way non_zero_entries does. */
+	inline int next_non_zero(int row_index, int column){
+
+		if(row_non_zero[row_index] == 0)
+			return used;
+
+		const unsigned char * bytes = (const unsigned char *) (entry + row_index*alloced);
+		size_t length = sizeof(EntryType) * used;
+		size_t byte = sizeof(EntryType) * column;
+
+		while(column < used){
+			if(byte + SCAN_BLOCK <= length && is_zero_block(bytes + byte)){
+				byte += SCAN_BLOCK;
+				column = byte / sizeof(EntryType);
+				continue;
+			}
+			if(!is_zero_entry(row_index, column))
+				return column;
+			column++;
+			byte = sizeof(EntryType) * column;
+		}
+		return used;
+	}
+
+	/* Number of non zero entries in the row */
+	inline int non_zero_count(int row_index){
+		return row_non_zero[row_index];
+	}
+
 	inline void zero_row(int row_index){
 		memset(entry + row_index*alloced, 0, sizeof(EntryType) * alloced);
+		row_non_zero[row_index] = 0;
 	}
 
 	inline void zero_column(int column_index){
-		for(int i = 0; i < alloced; i++){
+		for(int i = 0; i < used; i++){
 			zero_entry(i, column_index);
 		}
 	}
@@ -121,5 +248,194 @@ public:
 
 	}
 	
+};
+
+/*! Bit-packed specialization used by GraphAM when WeightType is bool, i.e. for unweighted graphs.
+Every entry takes one bit, 64 entries to a word, and each row is padded to a whole number of words
+so the row operations work a word at a time. */
+template <>
+class SquareMatrix<bool>{
+
+public:
+	uint64_t * words;
+	int used;
+	int alloced;
+	int row_words;
+
+	SquareMatrix(){
+		used = 0;
+		alloced = FIRST_ALLOC;
+		row_words = words_for(alloced);
+		words = new uint64_t[alloced * row_words];
+		memset(words, 0, sizeof(uint64_t) * alloced * row_words);
+	}
+
+	/*! Copies the matrix with one allocation and one bulk copy of the words */
+	SquareMatrix(const SquareMatrix& other){
+		words = nullptr;
+		copy_from(other);
+	}
+
+	SquareMatrix& operator=(const SquareMatrix& other){
+		if(this != &other)
+			copy_from(other);
+		return *this;
+	}
+
+	~SquareMatrix(){
+		delete[] words;
+	}
+
+	void copy_from(const SquareMatrix& other){
+		auto new_words = new uint64_t[other.alloced * other.row_words];
+		memcpy(new_words, other.words, sizeof(uint64_t) * other.alloced * other.row_words);
+		delete[] words;
+		words = new_words;
+		used = other.used;
+		alloced = other.alloced;
+		row_words = other.row_words;
+	}
+
+	void resize(){
+		resize_to(alloced * GROW_FACTOR);
+	}
+
+	/* Grows the matrix in one step, so that it has room for size rows and columns */
+	void reserve(int size){
+		if(size > alloced)
+			resize_to(size);
+	}
+
+	void resize_to(int new_alloced){
+
+		int new_row_words = words_for(new_alloced);
+
+		/* Get an empty array of bigger size */
+		auto new_words = new uint64_t[new_alloced * new_row_words];
+		memset(new_words, 0, sizeof(uint64_t) * new_alloced * new_row_words);
+
+		/* Rows only ever grow, so the old words of a row are a prefix of the new ones */
+		for(int i = 0; i < used; i++){
+			memcpy(new_words + i*new_row_words, words + i*row_words, sizeof(uint64_t) * row_words);
+		}
+
+		delete[] words;
+
+		words = new_words;
+		alloced = new_alloced;
+		row_words = new_row_words;
+	}
+
+	inline bool get_entry(int row_index, int column_index){
+		return (*word_of(row_index, column_index) >> (column_index & 63)) & 1;
+	}
+
+	inline void set_entry(int row_index, int column_index, bool value){
+		if(value){
+			*word_of(row_index, column_index) |= bit_of(column_index);
+		}else{
+			zero_entry(row_index, column_index);
+		}
+	}
+
+	inline void zero_entry(int row_index, int column_index){
+		*word_of(row_index, column_index) &= ~bit_of(column_index);
+	}
+
+	inline bool is_zero_entry(int row_index, int column_index){
+		return !get_entry(row_index, column_index);
+	}
+
+	/* Number of set bits in the row */
+	inline int non_zero_count(int row_index){
+		uint64_t * row = words + row_index*row_words;
+		int count = 0;
+		for(int w = 0; w < words_for(used); ++w){
+			count += __builtin_popcountll(row[w]);
+		}
+		return count;
+	}
+
+	inline std::vector<int> non_zero_entries(int row_index){
+		vector<int> temp;
+		uint64_t * row = words + row_index*row_words;
+
+		/* Skip empty words whole, and peel the set bits off the others */
+		for(int w = 0; w < words_for(used); ++w){
+			uint64_t bits = row[w];
+			while(bits){
+				temp.push_back(w*64 + __builtin_ctzll(bits));
+				bits &= bits - 1;
+			}
+		}
+		return temp;
+	}
+
+	/* Returns the first set column of the row at or after column, or used if there is none */
+	inline int next_non_zero(int row_index, int column){
+
+		uint64_t * row = words + row_index*row_words;
+		int last_word = words_for(used);
+		int w = column >> 6;
+		if(w >= last_word)
+			return used;
+
+		/* Mask off the columns before the start in the first word */
+		uint64_t bits = row[w] & (~uint64_t(0) << (column & 63));
+		while(!bits){
+			if(++w == last_word)
+				return used;
+			bits = row[w];
+		}
+		return w*64 + __builtin_ctzll(bits);
+	}
+
+	inline void zero_row(int row_index){
+		memset(words + row_index*row_words, 0, sizeof(uint64_t) * row_words);
+	}
+
+	inline void zero_column(int column_index){
+		uint64_t mask = ~bit_of(column_index);
+		uint64_t * column_word = words + (column_index >> 6);
+		for(int i = 0; i < used; i++){
+			column_word[i*row_words] &= mask;
+		}
+	}
+
+	inline void inc_used(){
+		used++;
+		if (used > alloced){
+			throw std::invalid_argument("horror");
+		}
+	}
+
+	inline bool full(){
+		return (used == alloced);
+	}
+
+	void print_matrix(){
+		for(int i = 0; i < alloced; i++){
+			for(int j = 0; j < alloced; j++){
+				cout << get_entry(i, j) << "\t";
+			}
+			cout << endl;
+		}
+
+	}
+
+private:
+
+	static inline int words_for(int columns){
+		return (columns + 63) / 64;
+	}
+
+	static inline uint64_t bit_of(int column_index){
+		return uint64_t(1) << (column_index & 63);
+	}
+
+	inline uint64_t * word_of(int row_index, int column_index){
+		return words + row_index*row_words + (column_index >> 6);
+	}
+
 };
 #endif
\ No newline at end of file
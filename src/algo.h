@@ -2,7 +2,18 @@
 #define ALGO_H
 
 #include "gcore.h"
+#include "parallel.h"
+#include "heap.h"
 #include <list>
+#include <limits>
+#include <cmath>
+#include <random>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 /*! \file */
 
@@ -12,66 +23,409 @@ template <typename I, typename D>
 using NodeSP = shared_ptr<Node<I, D>>;
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
 using GraphSP = shared_ptr<GraphType<I, W, D>>;
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+using ResultGraphSP = shared_ptr<typename result_graph<GraphType>::template type<I, W, D>>;
+
+/* Nodes whose out-edges a thread compares at a time in parallel_equal */
+#define EQUALITY_GRAIN 1024
+
+/*! Same as comparing the graphs with (==), with the out-edges of the nodes compared on num_threads()
+threads. Worth it for large graphs that have equal fingerprints */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+bool parallel_equal(const GraphSP<I, W, D, GraphType>& g1, const GraphSP<I, W, D, GraphType>& g2){
+
+	if constexpr(HasFingerprint<I, W, D, GraphType>){
+		if(g1->fingerprint() != g2->fingerprint())
+			return false;
+	}
+
+	vector<NodeSP<I, D>> nodes;
+	if(!same_nodes(g1, g2, nodes))
+		return false;
+
+	std::atomic<bool> equal(true);
+	size_t chunks = (nodes.size() + EQUALITY_GRAIN - 1) / EQUALITY_GRAIN;
+	parallel_for(0, chunks, [&](size_t chunk){
+		if(!equal.load(std::memory_order_relaxed))
+			return;
+		size_t last = min(nodes.size(), (chunk + 1) * EQUALITY_GRAIN);
+		if(!same_out_edges(g1, g2, nodes, chunk * EQUALITY_GRAIN, last))
+			equal = false;
+	}, 1);
+
+	return equal;
+}
+
+/* Colours of the nodes in a depth first search: not found yet, on the stack, done with */
+enum dfs_colour : char { DFS_WHITE, DFS_GREY, DFS_BLACK };
+
+/*! Base of the visitors of the depth first search engines. The engines call these hooks as they
+go; a visitor derives from DFSVisitor and hides the hooks it needs. The calls are resolved at compile
+time, so an empty hook costs nothing. The vertices are Nodes for the Graphs and dense indices for
+the dense graphs, and an edge is reported as its source, target and weight. An edge to a node on the
+stack is a back edge, an edge to a node that is done with a forward or cross edge. Once done returns
+true the search stops. */
+struct DFSVisitor{
+	template <typename V> inline void start_vertex(const V& u){}
+	template <typename V> inline void discover_vertex(const V& u){}
+	template <typename V, typename W> inline void examine_edge(const V& u, const V& v, const W& w){}
+	template <typename V, typename W> inline void tree_edge(const V& u, const V& v, const W& w){}
+	template <typename V, typename W> inline void back_edge(const V& u, const V& v, const W& w){}
+	template <typename V, typename W> inline void forward_or_cross_edge(const V& u, const V& v, const W& w){}
+	template <typename V> inline void finish_vertex(const V& u){}
+	inline bool done() const { return false; }
+};
+
+/*! The state of the dense depth first search: the colour of every node, and the stack of the
+nodes being visited with the position of the next out-edge to examine. The stack never holds a
+node twice, so the memory is linear in the number of nodes. Pass the same DenseDFS to consecutive
+searches to reuse its memory. */
+struct DenseDFS{
+	vector<char> colour;
+	vector<pair<int, size_t>> stack;
+
+	inline void reset(int n){
+		colour.assign(n, DFS_WHITE);
+		stack.clear();
+	}
+};
+
+/* The dense depth first search over the arrays of a compressed sparse row graph. state must
+already fit the graph */
+template <typename W, typename Visitor>
+bool depth_first_visit_csr(const size_t * offsets, const int * targets, const W * weights, int root,
+	Visitor& visitor, DenseDFS& state){
+
+	auto& colour = state.colour;
+	auto& stack = state.stack;
+	if(colour[root] != DFS_WHITE)
+		return true;
+
+	visitor.start_vertex(root);
+	colour[root] = DFS_GREY;
+	visitor.discover_vertex(root);
+	stack.clear();
+	stack.push_back(make_pair(root, offsets[root]));
+
+	while(!stack.empty()){
+		int u = stack.back().first;
+		size_t e = stack.back().second;
+
+		/* All out-edges examined */
+		if(e == offsets[u + 1]){
+			stack.pop_back();
+			colour[u] = DFS_BLACK;
+			visitor.finish_vertex(u);
+			if(visitor.done())
+				return false;
+			continue;
+		}
+
+		stack.back().second++;
+		int v = targets[e];
+		visitor.examine_edge(u, v, weights[e]);
+		if(colour[v] == DFS_WHITE){
+			visitor.tree_edge(u, v, weights[e]);
+			colour[v] = DFS_GREY;
+			visitor.discover_vertex(v);
+			stack.push_back(make_pair(v, offsets[v]));
+		}else if(colour[v] == DFS_GREY){
+			visitor.back_edge(u, v, weights[e]);
+		}else{
+			visitor.forward_or_cross_edge(u, v, weights[e]);
+		}
+		if(visitor.done())
+			return false;
+	}
+	return true;
+}
+
+/*! Depth first search from the node with dense index root, reporting to visitor. The nodes that
+state already marked are skipped, so consecutive visits with the same state cover a graph once;
+state is reset when it does not fit the graph. Returns false if the visitor stopped the search. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType,
+	typename Visitor>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+bool depth_first_visit_dense(const GraphSP<I, W, D, GraphType>& graph, int root, Visitor& visitor,
+	DenseDFS& state){
+
+	int n = graph->num_nodes();
+	if(root < 0 || root >= n){
+		throw std::invalid_argument("node not in the graph");
+	}
+	if(state.colour.size() != (size_t) n)
+		state.reset(n);
+
+	return depth_first_visit_csr(graph->offset_array(), graph->target_array(), graph->weight_array(), root,
+		visitor, state);
+}
+
+/*! Same as depth_first_visit_dense, with a fresh state */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType,
+	typename Visitor>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline bool depth_first_visit_dense(const GraphSP<I, W, D, GraphType>& graph, int root, Visitor& visitor){
+	DenseDFS state;
+	return depth_first_visit_dense(graph, root, visitor, state);
+}
+
+/*! Depth first search of the whole dense graph: visits from every node that is not found yet, in
+the order of the dense indices. Returns false if the visitor stopped the search. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType,
+	typename Visitor>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+bool depth_first_search_dense(const GraphSP<I, W, D, GraphType>& graph, Visitor& visitor, DenseDFS& state){
+	int n = graph->num_nodes();
+	state.reset(n);
+	for(int root = 0; root < n; ++root){
+		if(!depth_first_visit_dense(graph, root, visitor, state))
+			return false;
+	}
+	return true;
+}
+
+/*! Same as depth_first_search_dense, with a fresh state */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType,
+	typename Visitor>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline bool depth_first_search_dense(const GraphSP<I, W, D, GraphType>& graph, Visitor& visitor){
+	DenseDFS state;
+	return depth_first_search_dense(graph, visitor, state);
+}
+
+/*! Depth first search from Node root of Graph graph, reporting to visitor. The Nodes found by
+previous visits with the same colour map are skipped. The stack holds the out_edges iterators of
+the Nodes being visited, so nothing is copied out of the graph. Returns false if the visitor
+stopped the search. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType,
+	typename Visitor>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+bool depth_first_visit(const GraphSP<I, W, D, GraphType>& graph, const NodeSP<I, D>& root, Visitor& visitor,
+	FlatHashMap<I, char>& colour){
+
+	if(!has_node(graph, root)){
+		throw std::invalid_argument("node not in the graph");
+	}
+	if(colour.find(root->get_id()) != nullptr)
+		return true;
+
+	using iterator = decltype(graph->out_edges(root).begin());
+	struct frame{
+		NodeSP<I, D> node;
+		iterator next;
+		iterator end;
+	};
+
+	vector<frame> stack;
+	auto push = [&](const NodeSP<I, D>& u){
+		colour[u->get_id()] = DFS_GREY;
+		visitor.discover_vertex(u);
+		auto edges = graph->out_edges(u);
+		stack.push_back(frame{u, edges.begin(), edges.end()});
+	};
+
+	visitor.start_vertex(root);
+	push(root);
+
+	while(!stack.empty()){
+		auto& top = stack.back();
+
+		/* All out-edges examined */
+		if(top.next == top.end){
+			auto u = top.node;
+			stack.pop_back();
+			colour[u->get_id()] = DFS_BLACK;
+			visitor.finish_vertex(u);
+			if(visitor.done())
+				return false;
+			continue;
+		}
+
+		auto edge = *top.next;
+		++top.next;
+		auto u = top.node;
+		auto& v = edge.first;
+		visitor.examine_edge(u, v, edge.second);
+
+		auto found = colour.find(v->get_id());
+		if(found == nullptr){
+			visitor.tree_edge(u, v, edge.second);
+			push(v);
+		}else if(*found == DFS_GREY){
+			visitor.back_edge(u, v, edge.second);
+		}else{
+			visitor.forward_or_cross_edge(u, v, edge.second);
+		}
+		if(visitor.done())
+			return false;
+	}
+	return true;
+}
+
+/*! Same as depth_first_visit, with a fresh colour map */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType,
+	typename Visitor>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+inline bool depth_first_visit(const GraphSP<I, W, D, GraphType>& graph, const NodeSP<I, D>& root, Visitor& visitor){
+	FlatHashMap<I, char> colour;
+	return depth_first_visit(graph, root, visitor, colour);
+}
+
+/*! Depth first search of the whole Graph: visits from every Node that is not found yet, in the
+order of get_nodes. Returns false if the visitor stopped the search. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType,
+	typename Visitor>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+bool depth_first_search(const GraphSP<I, W, D, GraphType>& graph, Visitor& visitor){
+	auto nodes = get_nodes(graph);
+	FlatHashMap<I, char> colour;
+	colour.reserve(nodes.size());
+	for(auto& root : nodes){
+		if(!depth_first_visit(graph, root, visitor, colour))
+			return false;
+	}
+	return true;
+}
+
+/* Builds the tree of a depth first search as a Graph */
+template <typename TreeSP>
+struct TreeVisitor : DFSVisitor{
+	TreeSP tree;
+
+	TreeVisitor(TreeSP tree) : tree(tree) {}
+
+	template <typename V> inline void start_vertex(const V& u){
+		add_node(tree, u);
+	}
+
+	template <typename V, typename W> inline void tree_edge(const V& u, const V& v, const W& w){
+		add_node(tree, v);
+		add_edge(tree, create_edge(u, w, v));
+	}
+};
 
 /*! The DFS routine. Returns an instance of Graph that represnets a tree 
 created by the dfs from Node root to every other Node in Graph graph*/
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-GraphSP<I, W, D, GraphType> dfs(GraphSP<I, W, D, GraphType> graph, 
+ResultGraphSP<I, W, D, GraphType> dfs(GraphSP<I, W, D, GraphType> graph, 
 	NodeSP<I, D> root){
 
-	/* Initilization */
-	list<NodeSP<I, D>> temp;
-	map<I, bool> discovered_map;
-	map<I, EdgeSP<I, W, D>> predecessor;
-	auto tree = create_graph<I, W, D, GraphType>();
+	TreeVisitor<ResultGraphSP<I, W, D, GraphType>> visitor(
+		create_graph<I, W, D, result_graph<GraphType>::template type>());
+	depth_first_visit(graph, root, visitor);
+	return visitor.tree;
+}
 
+/* Collects the nodes in the order they are done with, and stops at the first back edge */
+template <typename V>
+struct FinishOrderVisitor : DFSVisitor{
+	vector<V> order;
+	bool cyclic = false;
 
-	/* Push the root */
-	temp.push_front(root);
+	template <typename W> inline void back_edge(const V& u, const V& v, const W& w){
+		cyclic = true;
+	}
 
-	while(!temp.empty()){
-		auto x = temp.front();
-		temp.pop_front();
+	inline void finish_vertex(const V& u){
+		order.push_back(u);
+	}
 
-		if (discovered_map.find(x->get_id()) == discovered_map.end()){
-			
-			/* Mark x as discovered */
-			discovered_map[x->get_id()] = true;
+	inline bool done() const {
+		return cyclic;
+	}
+};
 
-			/* Add the node to the tree we are building */
-			add_node(tree, x);
-				
-			/* Add the edge representig how we got there */
-			auto pred_p = predecessor.find(x->get_id());
+/* Keeps the path from the root of the search to the node being visited. At the first back edge
+the cycle is the path from the target of the edge to its source */
+template <typename V>
+struct CycleVisitor : DFSVisitor{
+	vector<V> path;
+	vector<V> cycle;
 
-			/* If prefeccessor exists, add the edge to the graph */
-			if(pred_p != predecessor.end()){
-				add_edge(tree, (*pred_p).second );
-			}
-		}
+	inline void discover_vertex(const V& u){
+		path.push_back(u);
+	}
 
-		/* Add all the neighbours to the que */
-		for(auto y : graph->neighbours(x)){
-			if (discovered_map.find(y->get_id()) == discovered_map.end()){
-				temp.push_front(y);
-				predecessor[y->get_id()] = get_edge(graph, x, y);
-			}
-		}
-		//}
+	inline void finish_vertex(const V& u){
+		path.pop_back();
 	}
-	return tree;
+
+	template <typename W> void back_edge(const V& u, const V& v, const W& w){
+		auto first = path.end();
+		while(!(*--first == v));
+		cycle.assign(first, path.end());
+	}
+
+	inline bool done() const {
+		return !cycle.empty();
+	}
+};
+
+/*! Returns the dense indices of the nodes in a topological order: every edge goes from a node to
+one that comes after it. Throws if the graph has a cycle */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+vector<int> topological_sort_dense(const GraphSP<I, W, D, GraphType>& graph){
+	FinishOrderVisitor<int> visitor;
+	visitor.order.reserve(graph->num_nodes());
+	if(!depth_first_search_dense(graph, visitor)){
+		throw std::invalid_argument("graph has a cycle");
+	}
+	reverse(visitor.order.begin(), visitor.order.end());
+	return visitor.order;
+}
+
+/*! Returns the Nodes of the Graph in a topological order: every edge goes from a Node to one that
+comes after it. Throws if the graph has a cycle */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+vector<NodeSP<I, D>> topological_sort(const GraphSP<I, W, D, GraphType>& graph){
+	FinishOrderVisitor<NodeSP<I, D>> visitor;
+	if(!depth_first_search(graph, visitor)){
+		throw std::invalid_argument("graph has a cycle");
+	}
+	reverse(visitor.order.begin(), visitor.order.end());
+	return visitor.order;
+}
+
+/*! Returns the dense indices of the nodes of a cycle, in the order of its edges, the last node
+having an edge back to the first. Returns an empty vector if the graph has no cycle */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+vector<int> find_cycle_dense(const GraphSP<I, W, D, GraphType>& graph){
+	CycleVisitor<int> visitor;
+	depth_first_search_dense(graph, visitor);
+	return visitor.cycle;
+}
+
+/*! Returns the Nodes of a cycle of the Graph, in the order of its edges, the last Node having an
+edge back to the first. Returns an empty vector if the graph has no cycle */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+vector<NodeSP<I, D>> find_cycle(const GraphSP<I, W, D, GraphType>& graph){
+	CycleVisitor<NodeSP<I, D>> visitor;
+	depth_first_search(graph, visitor);
+	return visitor.cycle;
+}
+
+/*! Checks if the Graph has a directed cycle */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+inline bool has_cycle(const GraphSP<I, W, D, GraphType>& graph){
+	return !find_cycle(graph).empty();
 }
 
 /*! The BFS routine. Returns an instance of Graph that represnets a tree 
 created by the dfs from Node root to every other Node in Graph graph*/
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-GraphSP<I, W, D, GraphType> bfs(GraphSP<I, W, D, GraphType> graph, NodeSP<I, D> root){
+ResultGraphSP<I, W, D, GraphType> bfs(GraphSP<I, W, D, GraphType> graph, NodeSP<I, D> root){
 
 	/* Initilization */
 	list<NodeSP<I, D>> q;
 	map<I, bool> discovered_map;
 	map<I, EdgeSP<I, W, D>> predecessor;
-	auto tree = create_graph<I, W, D, GraphType>();
+	auto tree = create_graph<I, W, D, result_graph<GraphType>::template type>();
 
 	/* Push the root */
 	q.push_front(root);
@@ -95,17 +449,2357 @@ GraphSP<I, W, D, GraphType> bfs(GraphSP<I, W, D, GraphType> graph, NodeSP<I, D>
 		}
 
 		/* Add all the neighbours to the que */
-		for(auto y : graph->neighbours(x)){
+		for(auto edge : out_edges(graph, x)){
+			auto& y = edge.first;
 			if (discovered_map.find(y->get_id()) == discovered_map.end()){
 				q.push_front(y);
 				discovered_map[y->get_id()] = true;
-				predecessor[y->get_id()] = get_edge(graph, x, y);
+				predecessor[y->get_id()] = create_edge(x, edge.second, y);
+			}
+		}
+	}
+	return tree;
+}
+
+/* Beamer's heuristics for the direction optimizing bfs: go bottom-up once the edges out of the
+frontier are more than 1 / BFS_ALPHA of the edges left to check, and top-down again once the
+frontier is smaller than 1 / BFS_BETA of the nodes */
+#define BFS_ALPHA 15
+#define BFS_BETA 18
+
+/*! The result of bfs_dense, indexed by the dense indices of the graph. parent[v] is the node v
+was reached from, the root is its own parent, and depth[v] is the number of edges from the root
+to v. Both are -1 for the nodes that were not reached. Pass the same DenseBFS to consecutive runs
+to reuse its memory. */
+struct DenseBFS{
+	vector<int> parent;
+	vector<int> depth;
+
+	inline bool reached(int v) const {
+		return parent[v] != -1;
+	}
+
+	/* Scratch space of the runs: the queue of the top-down steps, and the frontier bitmaps of
+	the bottom-up steps */
+	vector<int> queue;
+	vector<uint64_t> front;
+	vector<uint64_t> next;
+};
+
+/*! The BFS routine for dense graphs. Fills result with the bfs tree rooted at the node with dense
+index root, see DenseBFS. The frontier is expanded top-down, along out-edges, while it is small. When
+the graph stores in-edges (see freeze_graph) and the frontier grows large, the unreached nodes look
+for a parent in the frontier instead, bottom-up, which skips most of the edges into the frontier. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+void bfs_dense(const GraphSP<I, W, D, GraphType>& graph, int root, DenseBFS& result){
+
+	int n = graph->num_nodes();
+	if(root < 0 || root >= n){
+		throw std::invalid_argument("node not in the graph");
+	}
+
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	const size_t * in_offsets = nullptr;
+	const int * sources = nullptr;
+	if constexpr(HasDenseInEdges<I, W, D, GraphType>){
+		if(graph->has_in_edges()){
+			in_offsets = graph->in_offset_array();
+			sources = graph->source_array();
+		}
+	}
+
+	auto& parent = result.parent;
+	auto& depth = result.depth;
+	auto& queue = result.queue;
+	parent.assign(n, -1);
+	depth.assign(n, -1);
+	queue.resize(n);
+
+	parent[root] = root;
+	depth[root] = 0;
+	queue[0] = root;
+
+	/* The queue holds every reached node once, the frontier is [head, tail) */
+	size_t head = 0;
+	size_t tail = 1;
+	size_t frontier_edges = offsets[root + 1] - offsets[root];
+	size_t unexplored_edges = graph->num_edges();
+	int level = 0;
+
+	while(head < tail){
+
+		if(sources != nullptr && frontier_edges > unexplored_edges / BFS_ALPHA){
+
+			/* Bottom-up, with the frontier as a bitmap */
+			size_t words = (n + 63) / 64;
+			result.front.assign(words, 0);
+			for(size_t i = head; i < tail; ++i){
+				result.front[queue[i] >> 6] |= 1ull << (queue[i] & 63);
+			}
+
+			size_t awake = tail - head;
+			size_t old_awake;
+			do{
+				old_awake = awake;
+				awake = 0;
+				level++;
+				result.next.assign(words, 0);
+				for(int v = 0; v < n; ++v){
+					if(parent[v] != -1) continue;
+					for(size_t i = in_offsets[v]; i < in_offsets[v + 1]; ++i){
+						int u = sources[i];
+						if(result.front[u >> 6] & (1ull << (u & 63))){
+							parent[v] = u;
+							depth[v] = level;
+							result.next[v >> 6] |= 1ull << (v & 63);
+							awake++;
+							break;
+						}
+					}
+				}
+				swap(result.front, result.next);
+			}while(awake > 0 && (awake >= old_awake || awake > (size_t) n / BFS_BETA));
+
+			/* Back to a queue. Everything before the frontier is done with, so the queue restarts */
+			head = 0;
+			tail = 0;
+			frontier_edges = 0;
+			for(size_t w = 0; w < words; ++w){
+				for(uint64_t bits = result.front[w]; bits != 0; bits &= bits - 1){
+					int v = (w << 6) + __builtin_ctzll(bits);
+					queue[tail++] = v;
+					frontier_edges += offsets[v + 1] - offsets[v];
+				}
+			}
+
+		}else{
+
+			/* Top-down */
+			level++;
+			unexplored_edges -= min(unexplored_edges, frontier_edges);
+			frontier_edges = 0;
+			size_t next_tail = tail;
+			for(size_t i = head; i < tail; ++i){
+				int u = queue[i];
+				for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+					int v = targets[e];
+					if(parent[v] == -1){
+						parent[v] = u;
+						depth[v] = level;
+						queue[next_tail++] = v;
+						frontier_edges += offsets[v + 1] - offsets[v];
+					}
+				}
 			}
+			head = tail;
+			tail = next_tail;
 		}
 	}
-	cout << endl;
+}
+
+/*! Same as bfs_dense, returns a new DenseBFS */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline DenseBFS bfs_dense(const GraphSP<I, W, D, GraphType>& graph, int root){
+	DenseBFS result;
+	bfs_dense(graph, root, result);
+	return result;
+}
+
+/*! Same as bfs_dense, rooted at the Node root */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline DenseBFS bfs_dense(const GraphSP<I, W, D, GraphType>& graph, const NodeSP<I, D>& root){
+	return bfs_dense(graph, graph->index_of(root));
+}
+
+/* Builds the tree given by the parent of every dense index (-1 for the nodes out of the tree, the
+root is its own parent) as a TreeType graph, see bfs_tree */
+template <template <typename, typename, typename> typename TreeType, typename I, typename W, typename D, 
+	template <typename, typename, typename> typename GraphType>
+shared_ptr<TreeType<I, W, D>> build_parent_tree(const GraphSP<I, W, D, GraphType>& graph, const vector<int>& parent){
+
+	auto tree = create_graph<I, W, D, TreeType>();
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	const W * weights = graph->weight_array();
+
+	vector<NodeSP<I, D>> nodes;
+	vector<EdgeRecord<I, W>> records;
+	for(int v = 0; v < graph->num_nodes(); ++v){
+		if(parent[v] == -1) continue;
+		nodes.push_back(graph->node_at(v));
+
+		int u = parent[v];
+		if(u == v) continue;
+
+		/* Rows are sorted, so the weight of (u, v) is a binary search away */
+		auto position = lower_bound(targets + offsets[u], targets + offsets[u + 1], v) - targets;
+		records.push_back(EdgeRecord<I, W>{graph->node_at(u)->get_id(), weights[position], 
+			graph->node_at(v)->get_id()});
+	}
+
+	add_nodes(tree, nodes);
+	add_edges(tree, records);
 	return tree;
 }
 
+/*! Materializes the tree of a bfs_dense run as a Graph: the reached Nodes, and an edge from the
+parent of every reached Node but the root, with the weight it has in graph */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline ResultGraphSP<I, W, D, GraphType> bfs_tree(const GraphSP<I, W, D, GraphType>& graph, const DenseBFS& result){
+	return build_parent_tree<result_graph<GraphType>::template type>(graph, result.parent);
+}
+
+/* Frontier nodes, or bitmap words, a thread takes at a time in the parallel traversals. Smaller
+frontiers are expanded by fewer threads */
+#define PARALLEL_GRAIN 256
+
+/* Sets the parent of v to u, if v has none yet. Of the threads that race for v, only one wins */
+inline bool claim_parent(int * parent, int v, int u){
+	int expected = -1;
+	return __atomic_load_n(parent + v, __ATOMIC_RELAXED) == -1 &&
+		__atomic_compare_exchange_n(parent + v, &expected, u, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+/* Sets bit v of the bitmap. Returns true if this call set it */
+inline bool claim_bit(uint64_t * bits, int v){
+	uint64_t bit = 1ull << (v & 63);
+	if(__atomic_load_n(bits + (v >> 6), __ATOMIC_RELAXED) & bit)
+		return false;
+	return !(__atomic_fetch_or(bits + (v >> 6), bit, __ATOMIC_RELAXED) & bit);
+}
+
+/* One top-down step of the parallel traversals. The nodes of queue[head, tail) are split between
+the threads, and every thread claims (see claim_parent) the targets v of the out-edges e of its nodes
+u for which accept(u, e) holds, calls on_claim(thread, v) for them and keeps them in a frontier of its
+own, in local. The frontiers are then stitched together after tail, at offsets given by their sizes,
+so no locks are taken. Returns the new tail of the queue */
+template <typename Accept, typename OnClaim>
+size_t parallel_expand(const size_t * offsets, const int * targets, vector<int>& queue, size_t head,
+	size_t tail, int * parent, vector<vector<int>>& local, Accept accept, OnClaim on_claim){
+
+	unsigned threads = min(local.size(), (tail - head + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN);
+	atomic<size_t> next_index(head);
+	parallel_run(threads, [&](unsigned t){
+		auto& out = local[t];
+		out.clear();
+		while(true){
+			size_t first = next_index.fetch_add(PARALLEL_GRAIN);
+			if(first >= tail)
+				break;
+			size_t last = min(first + PARALLEL_GRAIN, tail);
+			for(size_t i = first; i < last; ++i){
+				int u = queue[i];
+				for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+					int v = targets[e];
+					if(accept(u, e) && claim_parent(parent, v, u)){
+						on_claim(t, v);
+						out.push_back(v);
+					}
+				}
+			}
+		}
+	});
+
+	/* Stitch the frontiers of the threads together */
+	vector<size_t> local_offsets(threads + 1);
+	local_offsets[0] = tail;
+	for(unsigned t = 0; t < threads; ++t){
+		local_offsets[t + 1] = local_offsets[t] + local[t].size();
+	}
+	parallel_run(threads, [&](unsigned t){
+		copy(local[t].begin(), local[t].end(), queue.begin() + local_offsets[t]);
+	});
+
+	return local_offsets[threads];
+}
+
+/*! The parallel version of bfs_dense, with the same result, up to the choice among parents of the same
+depth. Levels are expanded by num_threads() threads (see set_num_threads). Top-down, every thread
+collects the nodes it claims in a frontier of its own, and the frontiers are then stitched together
+at offsets given by their sizes, so no locks are taken. A node is claimed with a compare-and-swap on
+its parent. Bottom-up, every thread owns whole words of the next frontier bitmap. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+void parallel_bfs_dense(const GraphSP<I, W, D, GraphType>& graph, int root, DenseBFS& result){
+
+	int n = graph->num_nodes();
+	if(root < 0 || root >= n){
+		throw std::invalid_argument("node not in the graph");
+	}
+
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	const size_t * in_offsets = nullptr;
+	const int * sources = nullptr;
+	if constexpr(HasDenseInEdges<I, W, D, GraphType>){
+		if(graph->has_in_edges()){
+			in_offsets = graph->in_offset_array();
+			sources = graph->source_array();
+		}
+	}
+
+	auto& parent = result.parent;
+	auto& depth = result.depth;
+	auto& queue = result.queue;
+	parent.assign(n, -1);
+	depth.assign(n, -1);
+	queue.resize(n);
+
+	parent[root] = root;
+	depth[root] = 0;
+	queue[0] = root;
+
+	size_t head = 0;
+	size_t tail = 1;
+	size_t frontier_edges = offsets[root + 1] - offsets[root];
+	size_t unexplored_edges = graph->num_edges();
+	int level = 0;
+
+	vector<vector<int>> local(num_threads());
+	vector<size_t> local_edges(num_threads());
+	size_t words = (n + 63) / 64;
+
+	while(head < tail){
+
+		if(sources != nullptr && frontier_edges > unexplored_edges / BFS_ALPHA){
+
+			/* Bottom-up, with the frontier as a bitmap */
+			result.front.assign(words, 0);
+			parallel_for(head, tail, [&](size_t i){
+				claim_bit(result.front.data(), queue[i]);
+			}, PARALLEL_GRAIN);
+
+			size_t awake = tail - head;
+			size_t old_awake;
+			do{
+				old_awake = awake;
+				level++;
+				result.next.resize(words);
+				atomic<size_t> awake_count(0);
+
+				/* A block of 64 nodes is one word of the bitmap, so the words have one writer */
+				parallel_for(0, words, [&](size_t w){
+					uint64_t bits = 0;
+					size_t found = 0;
+					int last = min((size_t) n, (w + 1) * 64);
+					for(int v = w * 64; v < last; ++v){
+						if(parent[v] != -1) continue;
+						for(size_t i = in_offsets[v]; i < in_offsets[v + 1]; ++i){
+							int u = sources[i];
+							if(result.front[u >> 6] & (1ull << (u & 63))){
+								parent[v] = u;
+								depth[v] = level;
+								bits |= 1ull << (v & 63);
+								found++;
+								break;
+							}
+						}
+					}
+					result.next[w] = bits;
+					if(found > 0)
+						awake_count += found;
+				}, PARALLEL_GRAIN / 64);
+
+				awake = awake_count;
+				swap(result.front, result.next);
+			}while(awake > 0 && (awake >= old_awake || awake > (size_t) n / BFS_BETA));
+
+			/* Back to a queue, every word is written at the offset given by the counts before it */
+			vector<size_t> word_offsets(words + 1, 0);
+			for(size_t w = 0; w < words; ++w){
+				word_offsets[w + 1] = word_offsets[w] + __builtin_popcountll(result.front[w]);
+			}
+			atomic<size_t> edge_count(0);
+			parallel_for(0, words, [&](size_t w){
+				size_t slot = word_offsets[w];
+				size_t edges = 0;
+				for(uint64_t bits = result.front[w]; bits != 0; bits &= bits - 1){
+					int v = (w << 6) + __builtin_ctzll(bits);
+					queue[slot++] = v;
+					edges += offsets[v + 1] - offsets[v];
+				}
+				if(edges > 0)
+					edge_count += edges;
+			}, PARALLEL_GRAIN / 64);
+
+			head = 0;
+			tail = word_offsets[words];
+			frontier_edges = edge_count;
+
+		}else{
+
+			/* Top-down */
+			level++;
+			unexplored_edges -= min(unexplored_edges, frontier_edges);
+
+			for(auto& edges : local_edges){
+				edges = 0;
+			}
+			size_t next_tail = parallel_expand(offsets, targets, queue, head, tail, parent.data(), local,
+				[](int u, size_t e){ return true; },
+				[&](unsigned t, int v){
+					depth[v] = level;
+					local_edges[t] += offsets[v + 1] - offsets[v];
+				});
+
+			frontier_edges = 0;
+			for(auto edges : local_edges){
+				frontier_edges += edges;
+			}
+			head = tail;
+			tail = next_tail;
+		}
+	}
+}
+
+/*! Same as parallel_bfs_dense, returns a new DenseBFS */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline DenseBFS parallel_bfs_dense(const GraphSP<I, W, D, GraphType>& graph, int root){
+	DenseBFS result;
+	parallel_bfs_dense(graph, root, result);
+	return result;
+}
+
+/*! The parallel BFS routine for mutable graphs. Freezes the graph with in-edges, runs
+parallel_bfs_dense and returns the tree, like bfs does. To run many traversals of a graph
+that does not change, freeze it once and use parallel_bfs_dense instead. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+ResultGraphSP<I, W, D, GraphType> parallel_bfs(const GraphSP<I, W, D, GraphType>& graph, const NodeSP<I, D>& root){
+	auto frozen = freeze_graph(graph, true);
+	DenseBFS result;
+	parallel_bfs_dense(frozen, frozen->index_of(root), result);
+	return build_parent_tree<result_graph<GraphType>::template type>(frozen, result.parent);
+}
+
+/* Work shared between the threads of reachable_from_dense */
+#define REACH_SHARE_THRESHOLD 64
+
+/*! Marks every node reachable from one of the roots (the roots included), on num_threads() threads.
+The order of the visit does not matter here, so every thread runs its own depth first search from a
+local stack, and claims nodes with an atomic or on a visited bitmap. A thread that runs out of work
+takes a chunk that a busy thread left in a shared pool. Returns a flag per dense index. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+vector<char> reachable_from_dense(const GraphSP<I, W, D, GraphType>& graph, const vector<int>& roots){
+
+	int n = graph->num_nodes();
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	vector<uint64_t> visited((n + 63) / 64, 0);
+
+	/* The roots are the first chunks of work */
+	vector<vector<int>> pool;
+	for(auto root : roots){
+		if(root < 0 || root >= n){
+			throw std::invalid_argument("node not in the graph");
+		}
+		if(!claim_bit(visited.data(), root)) continue;
+		if(pool.empty() || pool.back().size() == REACH_SHARE_THRESHOLD)
+			pool.emplace_back();
+		pool.back().push_back(root);
+	}
+
+	unsigned threads = num_threads();
+	mutex pool_mutex;
+	condition_variable work_added;
+	atomic<unsigned> idle(0);
+	bool done = false;
+
+	parallel_run(threads, [&](unsigned){
+		vector<int> stack;
+		while(true){
+
+			if(stack.empty()){
+				unique_lock<mutex> lock(pool_mutex);
+				idle++;
+				while(pool.empty() && !done){
+					/* Nobody holds work, and nobody can add any */
+					if(idle == threads){
+						done = true;
+						work_added.notify_all();
+						break;
+					}
+					work_added.wait(lock);
+				}
+				if(pool.empty())
+					return;
+				idle--;
+				stack.swap(pool.back());
+				pool.pop_back();
+				continue;
+			}
+
+			int u = stack.back();
+			stack.pop_back();
+			for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+				int v = targets[e];
+				if(claim_bit(visited.data(), v))
+					stack.push_back(v);
+			}
+
+			/* Hand half of the stack to the threads that wait for work */
+			if(stack.size() >= REACH_SHARE_THRESHOLD && idle > 0){
+				size_t half = stack.size() / 2;
+				lock_guard<mutex> lock(pool_mutex);
+				pool.emplace_back(stack.begin(), stack.begin() + half);
+				stack.erase(stack.begin(), stack.begin() + half);
+				work_added.notify_one();
+			}
+		}
+	});
+
+	vector<char> reached(n);
+	parallel_for(0, n, [&](size_t v){
+		reached[v] = (visited[v >> 6] >> (v & 63)) & 1;
+	});
+	return reached;
+}
+
+/*! Returns the Nodes reachable from one of the roots, the roots included. Freezes the graph and
+runs reachable_from_dense, see there */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+vector<NodeSP<I, D>> reachable_from(const GraphSP<I, W, D, GraphType>& graph, const vector<NodeSP<I, D>>& roots){
+
+	auto frozen = freeze_graph(graph);
+	vector<int> root_indices;
+	for(auto& root : roots){
+		root_indices.push_back(frozen->index_of(root));
+	}
+
+	auto reached = reachable_from_dense(frozen, root_indices);
+	vector<NodeSP<I, D>> temp;
+	for(int v = 0; v < frozen->num_nodes(); ++v){
+		if(reached[v])
+			temp.push_back(frozen->node_at(v));
+	}
+	return temp;
+}
+
+/*! The result of the shortest path routines, indexed by the dense indices of the graph. distance[v]
+is the length of a shortest path from the source to v, and parent[v] the node before v on it, the
+source is its own parent. Nodes that were not reached have distance numeric_limits<W>::max() and
+parent -1. Pass the same ShortestPaths to consecutive runs to reuse its memory. */
+template <typename W>
+struct ShortestPaths{
+	vector<W> distance;
+	vector<int> parent;
+
+	inline bool reached(int v) const {
+		return parent[v] != -1;
+	}
+
+	/*! Returns the dense indices of a shortest path from the source to v, both included. The
+	path is empty if v was not reached */
+	vector<int> path_to(int v) const {
+		vector<int> path;
+		if(!reached(v))
+			return path;
+		for(; parent[v] != v; v = parent[v]){
+			path.push_back(v);
+		}
+		path.push_back(v);
+		reverse(path.begin(), path.end());
+		return path;
+	}
+
+	/* Scratch space of the runs */
+	IndexedHeap<W> heap;
+	vector<int> queue;
+};
+
+/* Shortest paths are only defined here for edges that do not have a negative weight */
+template <typename W>
+inline void check_weight(const W& w){
+	if constexpr(is_signed<W>::value){
+		if(w < 0){
+			throw std::invalid_argument("negative edge weight");
+		}
+	}
+}
+
+/*! Dijkstra's single source shortest paths for dense graphs. Fills result with the distances from
+the node with dense index source, see ShortestPaths. The nodes are settled in the order of their
+distance from an indexed 4-ary heap, with decrease-key on every shorter path found. When a target is
+given, the run stops once the target is settled: its distance and path are final, the rest of result
+may not be. Throws if a negative weight is met. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+void dijkstra_dense(const GraphSP<I, W, D, GraphType>& graph, int source, ShortestPaths<W>& result,
+	int target = -1){
+
+	int n = graph->num_nodes();
+	if(source < 0 || source >= n){
+		throw std::invalid_argument("node not in the graph");
+	}
+
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	const W * weights = graph->weight_array();
+
+	auto& distance = result.distance;
+	auto& parent = result.parent;
+	auto& heap = result.heap;
+	distance.assign(n, numeric_limits<W>::max());
+	parent.assign(n, -1);
+	/* A run stopped at its target leaves entries behind, and the last graph may have been smaller */
+	if(heap.capacity() != (size_t) n)
+		heap.resize(n);
+	else
+		heap.clear();
+
+	distance[source] = 0;
+	parent[source] = source;
+	heap.push(source, 0);
+
+	while(!heap.empty()){
+		int u = heap.pop();
+		if(u == target)
+			break;
+
+		W du = distance[u];
+		for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+			check_weight(weights[e]);
+			int v = targets[e];
+			W dv = du + weights[e];
+			if(dv < distance[v]){
+				distance[v] = dv;
+				parent[v] = u;
+				heap.push_or_decrease(v, dv);
+			}
+		}
+	}
+}
+
+/*! Same as dijkstra_dense, returns a new ShortestPaths */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline ShortestPaths<W> dijkstra_dense(const GraphSP<I, W, D, GraphType>& graph, int source, int target = -1){
+	ShortestPaths<W> result;
+	dijkstra_dense(graph, source, result, target);
+	return result;
+}
+
+/* Lowers *p to value if value is smaller. Returns true if this call lowered it */
+template <typename W>
+inline bool atomic_min(W * p, W value){
+	W current = __atomic_load_n(p, __ATOMIC_RELAXED);
+	while(value < current){
+		if(__atomic_compare_exchange_n(p, &current, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			return true;
+	}
+	return false;
+}
+
+/* Most buckets delta_stepping_dense keeps at a time, per thread */
+#define DELTA_MAX_BUCKETS (1 << 16)
+
+/*! Parallel single source shortest paths for large dense graphs, by delta-stepping. The nodes are
+kept in buckets of width delta by their tentative distance. The nodes of the lowest bucket are relaxed
+by all the threads at once, with an atomic min on the distances, and the relaxed nodes go to buckets
+kept by every thread for itself, until the bucket stays empty. A relaxation never lands further than
+max_weight / delta + 1 buckets past the current one, so the buckets are a cyclic array of that many
+and one more. With delta 0 the mean edge weight is used, and a delta that would need more than
+DELTA_MAX_BUCKETS buckets is raised. Once the distances are final, every node takes as its parent a node of a shortest path to it,
+found by a parallel traversal of the edges that lie on shortest paths, so the parents form a tree.
+Fills result, see ShortestPaths. Throws if a negative weight is met. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+void delta_stepping_dense(const GraphSP<I, W, D, GraphType>& graph, int source, ShortestPaths<W>& result,
+	W delta = 0){
+
+	int n = graph->num_nodes();
+	if(source < 0 || source >= n){
+		throw std::invalid_argument("node not in the graph");
+	}
+
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	const W * weights = graph->weight_array();
+	size_t m = graph->num_edges();
+
+	long double sum = 0;
+	W max_weight = 0;
+	for(size_t e = 0; e < m; ++e){
+		check_weight(weights[e]);
+		sum += weights[e];
+		max_weight = max(max_weight, weights[e]);
+	}
+	if(delta <= 0){
+		delta = m == 0 ? 1 : max((W) 1, (W) (sum / m));
+	}
+	if((size_t) (max_weight / delta) + 2 > DELTA_MAX_BUCKETS){
+		delta = max_weight / (DELTA_MAX_BUCKETS - 2) + 1;
+	}
+	size_t cycle = (size_t) (max_weight / delta) + 2;
+
+	auto& distance = result.distance;
+	auto& parent = result.parent;
+	auto& frontier = result.queue;
+	distance.assign(n, numeric_limits<W>::max());
+	parent.assign(n, -1);
+	distance[source] = 0;
+	frontier.assign(1, source);
+
+	unsigned max_threads = num_threads();
+	vector<vector<vector<int>>> buckets(max_threads);
+	size_t bucket = 0;
+
+	while(!frontier.empty()){
+
+		/* Relax the current bucket */
+		unsigned threads = min((size_t) max_threads, (frontier.size() + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN);
+		atomic<size_t> next_index(0);
+		parallel_run(threads, [&](unsigned t){
+			auto& own = buckets[t];
+			while(true){
+				size_t first = next_index.fetch_add(PARALLEL_GRAIN);
+				if(first >= frontier.size())
+					break;
+				size_t last = min(first + PARALLEL_GRAIN, frontier.size());
+				for(size_t i = first; i < last; ++i){
+					int u = frontier[i];
+					W du = __atomic_load_n(&distance[u], __ATOMIC_RELAXED);
+
+					/* The node was moved to a lower bucket, and is done with */
+					if(du / delta < (W) bucket)
+						continue;
+
+					for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+						W dv = du + weights[e];
+						if(atomic_min(&distance[targets[e]], dv)){
+							size_t slot = (size_t) (dv / delta) % cycle;
+							if(slot >= own.size())
+								own.resize(slot + 1);
+							own[slot].push_back(targets[e]);
+						}
+					}
+				}
+			}
+		});
+
+		/* The next bucket is the lowest one that any thread holds. The current one comes again
+		if the relaxations put nodes back into it */
+		size_t next_bucket = numeric_limits<size_t>::max();
+		for(size_t b = bucket; b < bucket + cycle && next_bucket == numeric_limits<size_t>::max(); ++b){
+			for(auto& own : buckets){
+				if(b % cycle < own.size() && !own[b % cycle].empty()){
+					next_bucket = b;
+					break;
+				}
+			}
+		}
+		frontier.clear();
+		if(next_bucket == numeric_limits<size_t>::max())
+			break;
+
+		bucket = next_bucket;
+		for(auto& own : buckets){
+			size_t slot = bucket % cycle;
+			if(slot < own.size()){
+				frontier.insert(frontier.end(), own[slot].begin(), own[slot].end());
+				own[slot].clear();
+			}
+		}
+	}
+
+	/* Parents along the edges that lie on shortest paths. A traversal from the source gives a tree
+	even when edges of weight 0 form cycles */
+	parent[source] = source;
+	frontier.resize(n);
+	frontier[0] = source;
+	vector<vector<int>> local(max_threads);
+	size_t head = 0;
+	size_t tail = 1;
+	while(head < tail){
+		size_t next_tail = parallel_expand(offsets, targets, frontier, head, tail, parent.data(), local,
+			[&](int u, size_t e){ return distance[u] + weights[e] == distance[targets[e]]; },
+			[](unsigned t, int v){});
+		head = tail;
+		tail = next_tail;
+	}
+}
+
+/*! Same as delta_stepping_dense, returns a new ShortestPaths */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline ShortestPaths<W> delta_stepping_dense(const GraphSP<I, W, D, GraphType>& graph, int source, W delta = 0){
+	ShortestPaths<W> result;
+	delta_stepping_dense(graph, source, result, delta);
+	return result;
+}
+
+/*! Materializes the shortest path tree of a run as a Graph: the reached Nodes, and an edge from the
+parent of every reached Node but the source, with the weight it has in graph */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline ResultGraphSP<I, W, D, GraphType> shortest_path_tree(const GraphSP<I, W, D, GraphType>& graph,
+	const ShortestPaths<W>& result){
+	return build_parent_tree<result_graph<GraphType>::template type>(graph, result.parent);
+}
+
+/*! Dijkstra's routine for mutable graphs. Freezes the graph, runs dijkstra_dense and returns the
+shortest path tree rooted at source, like bfs returns its tree. To answer many queries on a graph
+that does not change, freeze it once and use dijkstra_dense instead. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+ResultGraphSP<I, W, D, GraphType> dijkstra(const GraphSP<I, W, D, GraphType>& graph, const NodeSP<I, D>& source){
+	auto frozen = freeze_graph(graph);
+	ShortestPaths<W> result;
+	dijkstra_dense(frozen, frozen->index_of(source), result);
+	return build_parent_tree<result_graph<GraphType>::template type>(frozen, result.parent);
+}
+
+/*! Returns a shortest path from src to dst as a vector of Nodes, src and dst included, and puts its
+length in distance. The path is empty if dst cannot be reached from src. The run goes into result,
+so a stream of queries can pass the same ShortestPaths and allocate nothing after the first */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+vector<NodeSP<I, D>> shortest_path(const GraphSP<I, W, D, GraphType>& graph, const NodeSP<I, D>& src,
+	const NodeSP<I, D>& dst, W& distance, ShortestPaths<W>& result){
+
+	int target = graph->index_of(dst);
+	dijkstra_dense(graph, graph->index_of(src), result, target);
+	distance = result.distance[target];
+
+	vector<NodeSP<I, D>> path;
+	for(auto v : result.path_to(target)){
+		path.push_back(graph->node_at(v));
+	}
+	return path;
+}
+
+/*! Same as shortest_path, with a ShortestPaths of its own */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline vector<NodeSP<I, D>> shortest_path(const GraphSP<I, W, D, GraphType>& graph, const NodeSP<I, D>& src,
+	const NodeSP<I, D>& dst, W& distance){
+	ShortestPaths<W> result;
+	return shortest_path(graph, src, dst, distance, result);
+}
+
+/* Out-edges per node that connected_components_dense links in its first passes, and the nodes it
+samples to find the largest component */
+#define AFFOREST_ROUNDS 2
+#define AFFOREST_SAMPLES 1024
+
+/* Joins the trees of u and v in the union-find forest comp, by hooking the root with the larger
+index under the other. Safe to call from many threads at once */
+inline void link_components(int * comp, int u, int v){
+	int p1 = __atomic_load_n(comp + u, __ATOMIC_RELAXED);
+	int p2 = __atomic_load_n(comp + v, __ATOMIC_RELAXED);
+	while(p1 != p2){
+		int high = max(p1, p2);
+		int low = p1 + p2 - high;
+		int p_high = __atomic_load_n(comp + high, __ATOMIC_RELAXED);
+
+		/* Already hooked where we want it */
+		if(p_high == low)
+			break;
+		if(p_high == high && __atomic_compare_exchange_n(comp + high, &p_high, low, false,
+			__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			break;
+
+		p1 = __atomic_load_n(comp + __atomic_load_n(comp + high, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+		p2 = __atomic_load_n(comp + low, __ATOMIC_RELAXED);
+	}
+}
+
+/* Points every node of the forest comp straight at its root */
+inline void compress_components(int * comp, int n){
+	parallel_for(0, n, [&](size_t u){
+		while(true){
+			int p = __atomic_load_n(comp + u, __ATOMIC_RELAXED);
+			int pp = __atomic_load_n(comp + p, __ATOMIC_RELAXED);
+			if(p == pp)
+				break;
+			__atomic_store_n(comp + u, pp, __ATOMIC_RELAXED);
+		}
+	});
+}
+
+/*! Weakly connected components of a dense graph: edges join nodes whatever their direction.
+Returns the component of every node, labelled by the smallest dense index in it. The nodes are
+joined in a concurrent union-find forest (Afforest). The first AFFOREST_ROUNDS out-edges of every
+node are linked first, which usually leaves the largest component nearly whole; the nodes of that
+component then skip their other edges, as the nodes outside link them from their side. This needs
+the in-edges of the graph; without them every edge is linked. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+vector<int> connected_components_dense(const GraphSP<I, W, D, GraphType>& graph){
+
+	int n = graph->num_nodes();
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	const size_t * in_offsets = nullptr;
+	const int * sources = nullptr;
+	if constexpr(HasDenseInEdges<I, W, D, GraphType>){
+		if(graph->has_in_edges()){
+			in_offsets = graph->in_offset_array();
+			sources = graph->source_array();
+		}
+	}
+
+	vector<int> comp(n);
+	int * c = comp.data();
+	parallel_for(0, n, [&](size_t u){
+		c[u] = u;
+	});
+
+	/* Sparse sampling of the neighbourhoods */
+	for(int r = 0; r < AFFOREST_ROUNDS; ++r){
+		parallel_for(0, n, [&](size_t u){
+			if(offsets[u] + r < offsets[u + 1])
+				link_components(c, u, targets[offsets[u] + r]);
+		});
+		compress_components(c, n);
+	}
+
+	/* The most frequent root among a sample of the nodes is likely the one of the largest component */
+	int largest = -1;
+	if(in_offsets != nullptr && n > 0){
+		mt19937 random(n);
+		FlatHashMap<int, int> counts;
+		int best = 0;
+		for(int k = 0; k < AFFOREST_SAMPLES; ++k){
+			int root = c[random() % n];
+			int count = ++counts[root];
+			if(count > best){
+				best = count;
+				largest = root;
+			}
+		}
+	}
+
+	/* Link the rest of the edges */
+	parallel_for(0, n, [&](size_t u){
+		if(__atomic_load_n(c + u, __ATOMIC_RELAXED) == largest)
+			return;
+		for(size_t e = offsets[u] + AFFOREST_ROUNDS; e < offsets[u + 1]; ++e){
+			link_components(c, u, targets[e]);
+		}
+		if(in_offsets != nullptr){
+			for(size_t e = in_offsets[u]; e < in_offsets[u + 1]; ++e){
+				link_components(c, u, sources[e]);
+			}
+		}
+	}, PARALLEL_GRAIN);
+	compress_components(c, n);
+
+	return comp;
+}
+
+/* Groups the nodes of a frozen graph by their labels, in the order of the labels, which are the
+smallest dense index of every group */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+vector<vector<NodeSP<I, D>>> group_by_label(const GraphSP<I, W, D, GraphType>& frozen, const vector<int>& labels){
+	vector<int> slot(labels.size(), -1);
+	vector<vector<NodeSP<I, D>>> groups;
+	for(size_t u = 0; u < labels.size(); ++u){
+		if(slot[labels[u]] == -1){
+			slot[labels[u]] = groups.size();
+			groups.emplace_back();
+		}
+		groups[slot[labels[u]]].push_back(frozen->node_at(u));
+	}
+	return groups;
+}
+
+/*! Weakly connected components of a Graph, each as a vector of its Nodes. Freezes the graph with
+its in-edges and runs connected_components_dense. To label the nodes of a graph that does not
+change, freeze it once and use connected_components_dense instead. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+vector<vector<NodeSP<I, D>>> connected_components(const GraphSP<I, W, D, GraphType>& graph){
+	auto frozen = freeze_graph(graph, true);
+	auto comp = connected_components_dense(frozen);
+
+	return group_by_label(frozen, comp);
+}
+
+/* Tarjan's algorithm as a visitor of the dense depth first search. The nodes wait on a stack of
+their own until the root of their component is done with, and are then labelled by the smallest
+index among them */
+struct TarjanVisitor : DFSVisitor{
+	vector<int> index;
+	vector<int> low;
+	vector<int> comp;
+	vector<int> path;
+	vector<int> waiting;
+	int counter = 0;
+
+	TarjanVisitor(int n) : index(n, -1), low(n), comp(n, -1) {}
+
+	inline void discover_vertex(int u){
+		index[u] = low[u] = counter++;
+		path.push_back(u);
+		waiting.push_back(u);
+	}
+
+	/* Only the nodes still waiting are in the component of u */
+	template <typename W> inline void back_edge(int u, int v, const W& w){
+		low[u] = min(low[u], index[v]);
+	}
+
+	template <typename W> inline void forward_or_cross_edge(int u, int v, const W& w){
+		if(comp[v] == -1)
+			low[u] = min(low[u], index[v]);
+	}
+
+	void finish_vertex(int u){
+		path.pop_back();
+		if(low[u] < index[u]){
+			int parent = path.back();
+			low[parent] = min(low[parent], low[u]);
+			return;
+		}
+
+		auto first = waiting.end();
+		int label = u;
+		do{
+			--first;
+			label = min(label, *first);
+		}while(*first != u);
+		for(auto w = first; w != waiting.end(); ++w){
+			comp[*w] = label;
+		}
+		waiting.erase(first, waiting.end());
+	}
+};
+
+/*! Strongly connected components of a dense graph by Tarjan's algorithm, run on the iterative
+depth first search so deep graphs do not overflow the stack. Returns the component of every node,
+labelled by the smallest dense index in it, same as parallel_strongly_connected_components_dense. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+vector<int> strongly_connected_components_dense(const GraphSP<I, W, D, GraphType>& graph){
+	TarjanVisitor visitor(graph->num_nodes());
+	depth_first_search_dense(graph, visitor);
+	return visitor.comp;
+}
+
+/*! Strongly connected components of a Graph, each as a vector of its Nodes. Freezes the graph and
+runs strongly_connected_components_dense */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+vector<vector<NodeSP<I, D>>> strongly_connected_components(const GraphSP<I, W, D, GraphType>& graph){
+	auto frozen = freeze_graph(graph);
+	return group_by_label(frozen, strongly_connected_components_dense(frozen));
+}
+
+/* The in-edges of a dense graph as compressed sparse row arrays */
+struct DenseInEdges{
+	const size_t * offsets = nullptr;
+	const int * sources = nullptr;
+
+	/* Storage for the arrays when the graph does not track its in-edges */
+	vector<size_t> built_offsets;
+	vector<int> built_sources;
+};
+
+/* Fills in with the in-edges of graph, built by counting sort when the graph does not track them */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+void dense_in_edges(const GraphSP<I, W, D, GraphType>& graph, DenseInEdges& in){
+	if constexpr(HasDenseInEdges<I, W, D, GraphType>){
+		if(graph->has_in_edges()){
+			in.offsets = graph->in_offset_array();
+			in.sources = graph->source_array();
+			return;
+		}
+	}
+
+	int n = graph->num_nodes();
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	in.built_offsets.assign(n + 1, 0);
+	for(size_t e = 0; e < offsets[n]; ++e){
+		in.built_offsets[targets[e] + 1]++;
+	}
+	for(int v = 0; v < n; ++v){
+		in.built_offsets[v + 1] += in.built_offsets[v];
+	}
+	in.built_sources.resize(offsets[n]);
+	vector<size_t> next(in.built_offsets.begin(), in.built_offsets.end() - 1);
+	for(int u = 0; u < n; ++u){
+		for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+			in.built_sources[next[targets[e]]++] = u;
+		}
+	}
+	in.offsets = in.built_offsets.data();
+	in.sources = in.built_sources.data();
+}
+
+/* Passes of trimming parallel_strongly_connected_components_dense makes at most */
+#define SCC_TRIM_ROUNDS 4
+/* The colouring goes on while every round labels at least 1 / SCC_COLOUR_PROGRESS of the nodes left,
+and pushes colours to them at most SCC_COLOUR_WORK times over */
+#define SCC_COLOUR_PROGRESS 64
+#define SCC_COLOUR_WORK 16
+
+/* Raises *p to value if value is larger. Returns true if this call raised it */
+inline bool atomic_max(int * p, int value){
+	int current = __atomic_load_n(p, __ATOMIC_RELAXED);
+	while(current < value){
+		if(__atomic_compare_exchange_n(p, &current, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			return true;
+	}
+	return false;
+}
+
+/*! Strongly connected components of a large dense graph on num_threads() threads. Returns the
+component of every node, labelled by the smallest dense index in it. Nodes without incoming or
+outgoing edges are trimmed off first, as components of their own. The component of the node with
+the most edges, most often the giant one, is then found as the nodes that are reached both forwards
+and backwards from it by parallel BFS. The rest is coloured: the largest index that reaches a node
+is pushed along the edges, the node that keeps its own colour is the root of a component, and the
+component is what reaches the root backwards inside its colour. Once a round labels few nodes, the
+rest is left to Tarjan's algorithm. The backward searches use the in-edges of the graph; without
+them the reverse edges are built first. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+vector<int> parallel_strongly_connected_components_dense(const GraphSP<I, W, D, GraphType>& graph){
+
+	int n = graph->num_nodes();
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	DenseInEdges in;
+	dense_in_edges(graph, in);
+	const size_t * in_offsets = in.offsets;
+	const int * sources = in.sources;
+
+	/* A node is active until its component is known */
+	vector<int> comp(n, -1);
+	int * c = comp.data();
+	auto active = [&](int v){
+		return __atomic_load_n(c + v, __ATOMIC_RELAXED) == -1;
+	};
+	auto has_active = [&](const size_t * off, const int * adj, int u){
+		for(size_t e = off[u]; e < off[u + 1]; ++e){
+			if(adj[e] != u && active(adj[e]))
+				return true;
+		}
+		return false;
+	};
+
+	/* Trim */
+	for(int round = 0; round < SCC_TRIM_ROUNDS; ++round){
+		atomic<bool> trimmed(false);
+		parallel_for(0, n, [&](size_t u){
+			if(active(u) && (!has_active(offsets, targets, u) || !has_active(in_offsets, sources, u))){
+				__atomic_store_n(c + u, (int) u, __ATOMIC_RELAXED);
+				trimmed = true;
+			}
+		});
+		if(!trimmed)
+			break;
+	}
+
+	/* Forward and backward from the pivot */
+	int pivot = -1;
+	size_t best = 0;
+	for(int u = 0; u < n; ++u){
+		size_t degree = (offsets[u + 1] - offsets[u]) * (in_offsets[u + 1] - in_offsets[u]);
+		if(comp[u] == -1 && (pivot == -1 || degree > best)){
+			pivot = u;
+			best = degree;
+		}
+	}
+
+	unsigned max_threads = num_threads();
+	vector<vector<int>> local(max_threads);
+	vector<int> queue(n);
+	if(pivot != -1){
+		vector<int> forward(n, -1), backward(n, -1);
+		for(auto pass : {make_pair(offsets, targets), make_pair(in_offsets, sources)}){
+			auto& parent = pass.first == offsets ? forward : backward;
+			const int * adj = pass.second;
+			parent[pivot] = pivot;
+			queue[0] = pivot;
+			size_t head = 0;
+			size_t tail = 1;
+			while(head < tail){
+				size_t next_tail = parallel_expand(pass.first, adj, queue, head, tail, parent.data(), local,
+					[&](int u, size_t e){ return active(adj[e]); },
+					[](unsigned t, int v){});
+				head = tail;
+				tail = next_tail;
+			}
+		}
+		parallel_for(0, n, [&](size_t u){
+			if(forward[u] != -1 && backward[u] != -1)
+				c[u] = pivot;
+		});
+	}
+
+	/* Colouring rounds */
+	vector<int> colour(n);
+	vector<char> queued(n, 0);
+	int * col = colour.data();
+	char * q = queued.data();
+	vector<int> frontier;
+	vector<int> roots;
+	bool stalled = false;
+	while(!stalled){
+		frontier.clear();
+		for(int u = 0; u < n; ++u){
+			if(comp[u] == -1){
+				colour[u] = u;
+				frontier.push_back(u);
+			}
+		}
+		if(frontier.empty())
+			break;
+		size_t remaining = frontier.size();
+
+		/* Push the largest colours along the edges until they settle */
+		size_t pushed = 0;
+		while(!frontier.empty() && !stalled){
+			parallel_for(0, frontier.size(), [&](size_t i){
+				__atomic_store_n(q + frontier[i], 0, __ATOMIC_RELAXED);
+			});
+
+			unsigned threads = min((size_t) max_threads, (frontier.size() + PARALLEL_GRAIN - 1) / PARALLEL_GRAIN);
+			atomic<size_t> next_index(0);
+			parallel_run(threads, [&](unsigned t){
+				auto& out = local[t];
+				out.clear();
+				while(true){
+					size_t first = next_index.fetch_add(PARALLEL_GRAIN);
+					if(first >= frontier.size())
+						break;
+					size_t last = min(first + PARALLEL_GRAIN, frontier.size());
+					for(size_t i = first; i < last; ++i){
+						int u = frontier[i];
+						int cu = __atomic_load_n(col + u, __ATOMIC_RELAXED);
+						for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+							int v = targets[e];
+							char expected = 0;
+							if(active(v) && atomic_max(col + v, cu) &&
+								__atomic_compare_exchange_n(q + v, &expected, 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+								out.push_back(v);
+						}
+					}
+				}
+			});
+
+			frontier.clear();
+			for(unsigned t = 0; t < threads; ++t){
+				frontier.insert(frontier.end(), local[t].begin(), local[t].end());
+			}
+			pushed += frontier.size();
+			stalled = pushed > SCC_COLOUR_WORK * remaining;
+		}
+		if(stalled)
+			break;
+
+		/* Every root takes what reaches it backwards inside its colour */
+		roots.clear();
+		for(int u = 0; u < n; ++u){
+			if(comp[u] == -1 && colour[u] == u)
+				roots.push_back(u);
+		}
+		atomic<size_t> labelled(0);
+		parallel_for(0, roots.size(), [&](size_t i){
+			int root = roots[i];
+			vector<int> stack(1, root);
+			c[root] = root;
+			size_t found = 1;
+			while(!stack.empty()){
+				int v = stack.back();
+				stack.pop_back();
+				for(size_t e = in_offsets[v]; e < in_offsets[v + 1]; ++e){
+					int u = sources[e];
+					if(__atomic_load_n(col + u, __ATOMIC_RELAXED) == root && active(u)){
+						__atomic_store_n(c + u, root, __ATOMIC_RELAXED);
+						stack.push_back(u);
+						found++;
+					}
+				}
+			}
+			labelled += found;
+		}, 1);
+
+		/* Long paths colour slowly, one root at a time */
+		stalled = labelled * SCC_COLOUR_PROGRESS < remaining;
+	}
+
+	/* What the colouring left goes to Tarjan's algorithm, as a graph of its own */
+	if(stalled){
+		vector<int> original;
+		vector<int> compact(n, -1);
+		for(int u = 0; u < n; ++u){
+			if(comp[u] == -1){
+				compact[u] = original.size();
+				original.push_back(u);
+			}
+		}
+
+		const W * weights = graph->weight_array();
+		int m = original.size();
+		vector<size_t> sub_offsets(1, 0);
+		vector<int> sub_targets;
+		vector<W> sub_weights;
+		for(int i = 0; i < m; ++i){
+			int u = original[i];
+			for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+				if(compact[targets[e]] != -1){
+					sub_targets.push_back(compact[targets[e]]);
+					sub_weights.push_back(weights[e]);
+				}
+			}
+			sub_offsets.push_back(sub_targets.size());
+		}
+
+		TarjanVisitor visitor(m);
+		DenseDFS state;
+		state.reset(m);
+		for(int root = 0; root < m; ++root){
+			depth_first_visit_csr(sub_offsets.data(), sub_targets.data(), sub_weights.data(), root, visitor, state);
+		}
+		for(int i = 0; i < m; ++i){
+			c[original[i]] = original[visitor.comp[i]];
+		}
+	}
+
+	/* Label every component by its smallest index */
+	vector<int> smallest(n, n);
+	parallel_for(0, n, [&](size_t u){
+		atomic_min(&smallest[c[u]], (int) u);
+	});
+	parallel_for(0, n, [&](size_t u){
+		c[u] = smallest[c[u]];
+	});
+	return comp;
+}
+
+/* Splits the nodes 0 to n - 1 into parts ranges of about the same work, a node costing one plus
+its edges. Returns the parts + 1 bounds of the ranges */
+inline vector<int> edge_balanced_partition(const size_t * offsets, int n, unsigned parts){
+	vector<int> bounds(parts + 1, n);
+	size_t work = n + offsets[n];
+	int u = 0;
+	for(unsigned t = 0; t < parts; ++t){
+		size_t target = work / parts * t;
+		int low = u;
+		int high = n;
+		while(low < high){
+			int middle = low + (high - low) / 2;
+			if(middle + offsets[middle] < target)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+		bounds[t] = u = low;
+	}
+	return bounds;
+}
+
+/*! The result of the PageRank routines, indexed by the dense indices of the graph. The ranks sum to
+one. error is the L1 distance between the ranks of the last two iterations, the run converged if it
+is below the tolerance asked for. Pass the same PageRank to consecutive runs to reuse its memory. */
+struct PageRank{
+	vector<double> rank;
+	int iterations = 0;
+	double error = 0;
+
+	/* Scratch space of the runs */
+	vector<double> contribution;
+	vector<double> next_contribution;
+};
+
+/* The power iteration behind pagerank_dense and personalized_pagerank_dense. teleport is the
+distribution the random surfer jumps to, uniform when it is nullptr */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+void pagerank_iterate(const GraphSP<I, W, D, GraphType>& graph, const double * teleport, PageRank& result,
+	double damping, double tolerance, int max_iterations){
+
+	if(!(damping >= 0 && damping < 1)){
+		throw std::invalid_argument("damping must be in [0, 1)");
+	}
+
+	int n = graph->num_nodes();
+	const size_t * offsets = graph->offset_array();
+	DenseInEdges in;
+	dense_in_edges(graph, in);
+	const size_t * in_offsets = in.offsets;
+	const int * sources = in.sources;
+
+	auto& rank = result.rank;
+	auto& contribution = result.contribution;
+	auto& next_contribution = result.next_contribution;
+	rank.resize(n);
+	contribution.resize(n);
+	next_contribution.resize(n);
+	result.iterations = 0;
+	result.error = 0;
+	if(n == 0)
+		return;
+
+	/* Start from the teleport distribution. Dangling nodes pass their rank on through it */
+	double uniform = 1.0 / n;
+	double dangling = 0;
+	for(int u = 0; u < n; ++u){
+		rank[u] = teleport ? teleport[u] : uniform;
+		size_t degree = offsets[u + 1] - offsets[u];
+		if(degree > 0)
+			contribution[u] = rank[u] / degree;
+		else
+			dangling += rank[u];
+	}
+
+	/* Every thread pulls the ranks of its own nodes, the parts balanced by their in-edges */
+	unsigned threads = max(1u, min(num_threads(), (unsigned) ((n + in_offsets[n]) / (PARALLEL_GRAIN * 16) + 1)));
+	auto bounds = edge_balanced_partition(in_offsets, n, threads);
+	vector<double> thread_error(threads);
+	vector<double> thread_dangling(threads);
+
+	while(result.iterations < max_iterations){
+		double scale = 1 - damping + damping * dangling;
+		parallel_run(threads, [&](unsigned t){
+			double error = 0;
+			double lost = 0;
+			for(int v = bounds[t]; v < bounds[t + 1]; ++v){
+				double sum = 0;
+				for(size_t e = in_offsets[v]; e < in_offsets[v + 1]; ++e){
+					sum += contribution[sources[e]];
+				}
+				double r = scale * (teleport ? teleport[v] : uniform) + damping * sum;
+				error += fabs(r - rank[v]);
+				rank[v] = r;
+
+				size_t degree = offsets[v + 1] - offsets[v];
+				if(degree > 0)
+					next_contribution[v] = r / degree;
+				else
+					lost += r;
+			}
+			thread_error[t] = error;
+			thread_dangling[t] = lost;
+		});
+
+		contribution.swap(next_contribution);
+		result.error = 0;
+		dangling = 0;
+		for(unsigned t = 0; t < threads; ++t){
+			result.error += thread_error[t];
+			dangling += thread_dangling[t];
+		}
+		result.iterations++;
+		if(result.error < tolerance)
+			break;
+	}
+}
+
+/*! PageRank of the nodes of a dense graph, by power iteration. Every iteration pulls the ranks
+along the in-edges, on num_threads() threads that each own a range of nodes with about the same
+number of in-edges; graphs frozen without their in-edges have them built first. The rank of the
+nodes without out-edges is spread over all the nodes. Stops once the ranks change by less than
+tolerance in L1 norm, or after max_iterations. Fills result, see PageRank. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline void pagerank_dense(const GraphSP<I, W, D, GraphType>& graph, PageRank& result, double damping = 0.85,
+	double tolerance = 1e-6, int max_iterations = 100){
+	pagerank_iterate(graph, nullptr, result, damping, tolerance, max_iterations);
+}
+
+/*! Same as pagerank_dense, returns a new PageRank */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline PageRank pagerank_dense(const GraphSP<I, W, D, GraphType>& graph, double damping = 0.85,
+	double tolerance = 1e-6, int max_iterations = 100){
+	PageRank result;
+	pagerank_dense(graph, result, damping, tolerance, max_iterations);
+	return result;
+}
+
+/*! Personalized PageRank of the nodes of a dense graph: same as pagerank_dense, but the random
+surfer jumps to the nodes in proportion to personalization, which has a non negative weight for
+every dense index, and so does the rank of the nodes without out-edges. Throws if personalization
+does not fit the graph or has no positive weight. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+void personalized_pagerank_dense(const GraphSP<I, W, D, GraphType>& graph, const vector<double>& personalization,
+	PageRank& result, double damping = 0.85, double tolerance = 1e-6, int max_iterations = 100){
+
+	if(personalization.size() != (size_t) graph->num_nodes()){
+		throw std::invalid_argument("personalization does not fit the graph");
+	}
+	double total = 0;
+	for(auto weight : personalization){
+		if(!(weight >= 0))
+			throw std::invalid_argument("negative personalization weight");
+		total += weight;
+	}
+	if(!(total > 0)){
+		throw std::invalid_argument("personalization has no positive weight");
+	}
+
+	vector<double> teleport(personalization.size());
+	for(size_t u = 0; u < teleport.size(); ++u){
+		teleport[u] = personalization[u] / total;
+	}
+	pagerank_iterate(graph, teleport.data(), result, damping, tolerance, max_iterations);
+}
+
+/*! Same as personalized_pagerank_dense, returns a new PageRank */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline PageRank personalized_pagerank_dense(const GraphSP<I, W, D, GraphType>& graph,
+	const vector<double>& personalization, double damping = 0.85, double tolerance = 1e-6, int max_iterations = 100){
+	PageRank result;
+	personalized_pagerank_dense(graph, personalization, result, damping, tolerance, max_iterations);
+	return result;
+}
+
+/*! PageRank of the Nodes of a Graph, as (Node, rank) pairs. Freezes the graph with its in-edges and
+runs pagerank_dense. To rank a graph that does not change, freeze it once and use pagerank_dense. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+vector<pair<NodeSP<I, D>, double>> pagerank(const GraphSP<I, W, D, GraphType>& graph, double damping = 0.85,
+	double tolerance = 1e-6, int max_iterations = 100){
+
+	auto frozen = freeze_graph(graph, true);
+	auto result = pagerank_dense(frozen, damping, tolerance, max_iterations);
+	vector<pair<NodeSP<I, D>, double>> ranks;
+	ranks.reserve(result.rank.size());
+	for(size_t u = 0; u < result.rank.size(); ++u){
+		ranks.push_back(make_pair(frozen->node_at(u), result.rank[u]));
+	}
+	return ranks;
+}
+
+/*! Personalized PageRank of the Nodes of a Graph, with the random surfer jumping back to the seeds
+only, as (Node, rank) pairs. Freezes the graph with its in-edges and runs personalized_pagerank_dense */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+vector<pair<NodeSP<I, D>, double>> personalized_pagerank(const GraphSP<I, W, D, GraphType>& graph,
+	const vector<NodeSP<I, D>>& seeds, double damping = 0.85, double tolerance = 1e-6, int max_iterations = 100){
+
+	auto frozen = freeze_graph(graph, true);
+	vector<double> personalization(frozen->num_nodes(), 0);
+	for(auto& seed : seeds){
+		personalization[frozen->index_of(seed)] = 1;
+	}
+	auto result = personalized_pagerank_dense(frozen, personalization, damping, tolerance, max_iterations);
+	vector<pair<NodeSP<I, D>, double>> ranks;
+	ranks.reserve(result.rank.size());
+	for(size_t u = 0; u < result.rank.size(); ++u){
+		ranks.push_back(make_pair(frozen->node_at(u), result.rank[u]));
+	}
+	return ranks;
+}
+
+/* Nodes a thread takes at a time when counting triangles. Small, as the work per node is skewed */
+#define TRIANGLE_GRAIN 64
+
+/* Calls on_match(x) for every x in both of the sorted lists of distinct values a and b. With SSE2
+the lists are merged four values against four: every value of a block of a is compared to all
+the rotations of a block of b at once, and the block with the smaller last value moves on */
+template <typename OnMatch>
+inline void intersect_sorted(const int * a, size_t na, const int * b, size_t nb, OnMatch on_match){
+	size_t i = 0;
+	size_t j = 0;
+#ifdef __SSE2__
+	while(i + 4 <= na && j + 4 <= nb){
+		__m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+		__m128i vb = _mm_loadu_si128((const __m128i *) (b + j));
+		__m128i equal = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x39))),
+			_mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x4e)), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x93))));
+		for(int mask = _mm_movemask_ps(_mm_castsi128_ps(equal)); mask != 0; mask &= mask - 1){
+			on_match(a[i + __builtin_ctz(mask)]);
+		}
+		int last_a = a[i + 3];
+		int last_b = b[j + 3];
+		if(last_a <= last_b)
+			i += 4;
+		if(last_b <= last_a)
+			j += 4;
+	}
+#endif
+	while(i < na && j < nb){
+		if(a[i] < b[j]){
+			i++;
+		}else if(b[j] < a[i]){
+			j++;
+		}else{
+			on_match(a[i]);
+			i++;
+			j++;
+		}
+	}
+}
+
+/* A dense graph seen as undirected, without self loops, and oriented by degree: every edge is kept
+once, at the end with the lower (degree, index), so no node keeps more than about the square root of
+the edges. The kept neighbours are sorted by index */
+struct OrientedGraph{
+	vector<int> degree;
+	vector<size_t> offsets;
+	vector<int> targets;
+};
+
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+void orient_by_degree(const GraphSP<I, W, D, GraphType>& graph, OrientedGraph& oriented){
+
+	int n = graph->num_nodes();
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	DenseInEdges in;
+	dense_in_edges(graph, in);
+
+	/* All the neighbours, both ways, sorted and without repeats */
+	vector<size_t> bounds(n + 1, 0);
+	for(int u = 0; u < n; ++u){
+		bounds[u + 1] = bounds[u] + (offsets[u + 1] - offsets[u]) + (in.offsets[u + 1] - in.offsets[u]);
+	}
+	vector<int> all(bounds[n]);
+	auto& degree = oriented.degree;
+	degree.resize(n);
+	parallel_for(0, n, [&](size_t u){
+		int * first = all.data() + bounds[u];
+		int * last = copy(targets + offsets[u], targets + offsets[u + 1], first);
+		last = copy(in.sources + in.offsets[u], in.sources + in.offsets[u + 1], last);
+		sort(first, last);
+		last = unique(first, last);
+		last = remove(first, last, (int) u);
+		degree[u] = last - first;
+	}, TRIANGLE_GRAIN);
+
+	auto higher = [&](int v, int u){
+		return degree[v] > degree[u] || (degree[v] == degree[u] && v > u);
+	};
+
+	auto& kept_offsets = oriented.offsets;
+	kept_offsets.assign(n + 1, 0);
+	parallel_for(0, n, [&](size_t u){
+		kept_offsets[u + 1] = count_if(all.begin() + bounds[u], all.begin() + bounds[u] + degree[u],
+			[&](int v){ return higher(v, u); });
+	}, TRIANGLE_GRAIN);
+	for(int u = 0; u < n; ++u){
+		kept_offsets[u + 1] += kept_offsets[u];
+	}
+
+	auto& kept = oriented.targets;
+	kept.resize(kept_offsets[n]);
+	parallel_for(0, n, [&](size_t u){
+		copy_if(all.begin() + bounds[u], all.begin() + bounds[u] + degree[u], kept.begin() + kept_offsets[u],
+			[&](int v){ return higher(v, u); });
+	}, TRIANGLE_GRAIN);
+}
+
+/*! Counts the triangles of a dense graph, with the edges taken as undirected and self loops left
+out. Every triangle is found once, from its node of the lowest degree, by intersecting sorted
+neighbour lists. Runs on num_threads() threads that take the nodes as they become free. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+size_t count_triangles_dense(const GraphSP<I, W, D, GraphType>& graph){
+	OrientedGraph oriented;
+	orient_by_degree(graph, oriented);
+	const size_t * offsets = oriented.offsets.data();
+	const int * targets = oriented.targets.data();
+
+	atomic<size_t> total(0);
+	parallel_for(0, graph->num_nodes(), [&](size_t u){
+		size_t found = 0;
+		for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+			int v = targets[e];
+			intersect_sorted(targets + offsets[u], offsets[u + 1] - offsets[u],
+				targets + offsets[v], offsets[v + 1] - offsets[v], [&](int w){ found++; });
+		}
+		if(found > 0)
+			total += found;
+	}, TRIANGLE_GRAIN);
+	return total;
+}
+
+/* Counts the triangles every node is in, and leaves the undirected degrees in oriented */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+vector<size_t> node_triangles_dense(const GraphSP<I, W, D, GraphType>& graph, OrientedGraph& oriented){
+	orient_by_degree(graph, oriented);
+	const size_t * offsets = oriented.offsets.data();
+	const int * targets = oriented.targets.data();
+
+	vector<size_t> triangles(graph->num_nodes(), 0);
+	size_t * t = triangles.data();
+	parallel_for(0, graph->num_nodes(), [&](size_t u){
+		size_t found = 0;
+		for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+			int v = targets[e];
+			size_t with_v = 0;
+			intersect_sorted(targets + offsets[u], offsets[u + 1] - offsets[u],
+				targets + offsets[v], offsets[v + 1] - offsets[v], [&](int w){
+					__atomic_fetch_add(t + w, 1, __ATOMIC_RELAXED);
+					with_v++;
+				});
+			if(with_v > 0)
+				__atomic_fetch_add(t + v, with_v, __ATOMIC_RELAXED);
+			found += with_v;
+		}
+		if(found > 0)
+			__atomic_fetch_add(t + u, found, __ATOMIC_RELAXED);
+	}, TRIANGLE_GRAIN);
+	return triangles;
+}
+
+/*! Counts the triangles every node of a dense graph is in, see count_triangles_dense */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline vector<size_t> node_triangles_dense(const GraphSP<I, W, D, GraphType>& graph){
+	OrientedGraph oriented;
+	return node_triangles_dense(graph, oriented);
+}
+
+/*! Local clustering coefficients of the nodes of a dense graph, with the edges taken as undirected:
+the triangles of a node over the pairs of its neighbours. Nodes with less than two neighbours get 0 */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+vector<double> clustering_coefficients_dense(const GraphSP<I, W, D, GraphType>& graph){
+	OrientedGraph oriented;
+	auto triangles = node_triangles_dense(graph, oriented);
+	vector<double> coefficients(triangles.size(), 0);
+	parallel_for(0, triangles.size(), [&](size_t u){
+		double d = oriented.degree[u];
+		if(d > 1)
+			coefficients[u] = 2 * triangles[u] / (d * (d - 1));
+	});
+	return coefficients;
+}
+
+/*! Counts the triangles of a Graph, see count_triangles_dense. Freezes the graph with its in-edges */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+inline size_t count_triangles(const GraphSP<I, W, D, GraphType>& graph){
+	return count_triangles_dense(freeze_graph(graph, true));
+}
+
+/*! Local clustering coefficients of the Nodes of a Graph, as (Node, coefficient) pairs, see
+clustering_coefficients_dense. Freezes the graph with its in-edges */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+vector<pair<NodeSP<I, D>, double>> clustering_coefficients(const GraphSP<I, W, D, GraphType>& graph){
+	auto frozen = freeze_graph(graph, true);
+	auto coefficients = clustering_coefficients_dense(frozen);
+	vector<pair<NodeSP<I, D>, double>> result;
+	result.reserve(coefficients.size());
+	for(size_t u = 0; u < coefficients.size(); ++u){
+		result.push_back(make_pair(frozen->node_at(u), coefficients[u]));
+	}
+	return result;
+}
+
+/* Side of the square tiles the blocked Floyd-Warshall works on, in entries. Three tiles should fit
+in the cache of a core */
+#define APSP_BLOCK 128
+
+/*! The result of all_pairs_shortest_paths: the distances between all the pairs of nodes, indexed
+by the dense indices of the nodes, as an n by n matrix. A distance is numeric_limits<W>::max() if
+there is no path. When asked for, the next hops are kept as well: the node that follows i on a
+shortest path from i to j, so a path is read one hop at a time. */
+template <typename I, typename W, typename D>
+struct AllPairsShortestPaths{
+
+	/* The Nodes by dense index */
+	vector<NodeSP<I, D>> nodes;
+	FlatHashMap<I, int> index;
+
+	/* Row major, with rows of stride entries */
+	size_t stride = 0;
+	vector<W> distances;
+	vector<int> next_hops;
+
+	inline int size() const {
+		return nodes.size();
+	}
+
+	int index_of(const NodeSP<I, D>& x) const {
+		auto i = index.find(x->get_id());
+		if(i == nullptr)
+			throw std::invalid_argument("node not in the graph");
+		return *i;
+	}
+
+	inline W distance(int i, int j) const {
+		return distances[i * stride + j];
+	}
+
+	inline bool reachable(int i, int j) const {
+		return distance(i, j) != numeric_limits<W>::max();
+	}
+
+	/*! The node after i on a shortest path from i to j, -1 if there is no path. Throws if the next
+	hops were not kept */
+	int next_hop(int i, int j) const {
+		if(next_hops.empty())
+			throw std::logic_error("next hops are not kept");
+		return next_hops[i * stride + j];
+	}
+
+	/*! Dense indices of a shortest path from i to j, both included. Empty if there is no path */
+	vector<int> path(int i, int j) const {
+		vector<int> hops;
+		if(!reachable(i, j))
+			return hops;
+		hops.push_back(i);
+		while(i != j){
+			i = next_hop(i, j);
+			hops.push_back(i);
+		}
+		return hops;
+	}
+
+	inline W distance(const NodeSP<I, D>& src, const NodeSP<I, D>& dst) const {
+		return distance(index_of(src), index_of(dst));
+	}
+
+	vector<NodeSP<I, D>> path(const NodeSP<I, D>& src, const NodeSP<I, D>& dst) const {
+		vector<NodeSP<I, D>> hops;
+		for(auto i : path(index_of(src), index_of(dst))){
+			hops.push_back(nodes[i]);
+		}
+		return hops;
+	}
+};
+
+/* c[j] = min(c[j], a + b[j]) over a row of a tile. A plain loop over restricted pointers, so the
+compiler vectorizes it with the widest min it has for W. Checked keeps unreachable entries of b
+unreachable when a is negative */
+template <bool Checked, typename W>
+inline void min_plus_row(W * __restrict c, const W * __restrict b, W a, W unreachable){
+	for(int j = 0; j < APSP_BLOCK; ++j){
+		W through = Checked && b[j] >= unreachable ? unreachable : a + b[j];
+		c[j] = through < c[j] ? through : c[j];
+	}
+}
+
+/* Same, and moves the next hop of an improved entry to the one towards k */
+template <bool Checked, typename W>
+inline void min_plus_row(W * __restrict c, int * __restrict c_next, const W * __restrict b, W a, int a_next,
+	W unreachable){
+	for(int j = 0; j < APSP_BLOCK; ++j){
+		W through = Checked && b[j] >= unreachable ? unreachable : a + b[j];
+		bool better = through < c[j];
+		c[j] = better ? through : c[j];
+		c_next[j] = better ? a_next : c_next[j];
+	}
+}
+
+/* Relaxes the tile at block row ci and block column cj through the nodes k of block kb, in order:
+d[i][j] = min(d[i][j], d[i][k] + d[k][j]). The tiles read may be the one written */
+template <typename W>
+void min_plus_tile(W * d, int * next, size_t stride, int ci, int cj, int kb, W unreachable){
+	for(int k = kb * APSP_BLOCK; k < (kb + 1) * APSP_BLOCK; ++k){
+		const W * b = d + k * stride + cj * APSP_BLOCK;
+		for(int i = ci * APSP_BLOCK; i < (ci + 1) * APSP_BLOCK; ++i){
+
+			/* Rows without a path to k, and k itself, change nothing */
+			W a = d[i * stride + k];
+			if(i == k || a >= unreachable)
+				continue;
+
+			W * c = d + i * stride + cj * APSP_BLOCK;
+			bool negative = false;
+			if constexpr(is_signed<W>::value)
+				negative = a < 0;
+			if(next != nullptr){
+				int * c_next = next + i * stride + cj * APSP_BLOCK;
+				int a_next = next[i * stride + k];
+				if(negative)
+					min_plus_row<true>(c, c_next, b, a, a_next, unreachable);
+				else
+					min_plus_row<false>(c, c_next, b, a, a_next, unreachable);
+			}else{
+				if(negative)
+					min_plus_row<true>(c, b, a, unreachable);
+				else
+					min_plus_row<false>(c, b, a, unreachable);
+			}
+		}
+	}
+}
+
+/*! All pairs shortest paths by Floyd-Warshall, on a copy of the adjacency matrix: the rows of a
+GraphAM are copied as they are, other graphs have their edges written out. The matrix is cut in
+square tiles of APSP_BLOCK. For every block of k, the diagonal tile is done first, then the tiles
+in its row and column, then all the other tiles, each step on num_threads() threads. Edge weights
+may be negative as long as there is no negative cycle, which throws; distances must stay below half
+of numeric_limits<W>::max(). With with_next_hops the next hops are kept for reading the paths. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+AllPairsShortestPaths<I, W, D> all_pairs_shortest_paths(const GraphSP<I, W, D, GraphType>& graph,
+	bool with_next_hops = false){
+
+	AllPairsShortestPaths<I, W, D> result;
+	auto& nodes = result.nodes;
+	W unreachable = numeric_limits<W>::max() / 2;
+
+	/* The rows in use of the matrix, or the nodes, get the dense indices in order */
+	vector<int> rows;
+	if constexpr(HasAdjacencyMatrix<I, W, D, GraphType>){
+		for(int row = 0; row < graph->matrix_rows(); ++row){
+			auto x = graph->node_of_row(row);
+			if(x != nullptr){
+				rows.push_back(row);
+				nodes.push_back(x);
+			}
+		}
+	}else{
+		nodes = get_nodes(graph);
+	}
+	int n = nodes.size();
+	result.index.reserve(n);
+	for(int i = 0; i < n; ++i){
+		result.index[nodes[i]->get_id()] = i;
+	}
+
+	int blocks = (n + APSP_BLOCK - 1) / APSP_BLOCK;
+	size_t stride = (size_t) blocks * APSP_BLOCK;
+	result.stride = stride;
+	auto& d = result.distances;
+	d.assign(stride * stride, unreachable);
+
+	if constexpr(HasAdjacencyMatrix<I, W, D, GraphType>){
+		parallel_for(0, n, [&](size_t i){
+			const W * row = graph->matrix_row(rows[i]);
+			W * out = d.data() + i * stride;
+			for(int j = 0; j < n; ++j){
+				W w = row[rows[j]];
+				if(w != 0)
+					out[j] = w;
+			}
+		});
+	}else{
+		for(int i = 0; i < n; ++i){
+			for(auto edge : out_edges(graph, nodes[i])){
+				d[i * stride + result.index_of(edge.first)] = edge.second;
+			}
+		}
+	}
+	for(size_t i = 0; i < stride; ++i){
+		d[i * stride + i] = min((W) 0, d[i * stride + i]);
+	}
+
+	int * next = nullptr;
+	if(with_next_hops){
+		result.next_hops.assign(stride * stride, -1);
+		next = result.next_hops.data();
+		parallel_for(0, stride, [&](size_t i){
+			for(size_t j = 0; j < stride; ++j){
+				if(d[i * stride + j] < unreachable)
+					next[i * stride + j] = j;
+			}
+		});
+	}
+
+	W * dist = d.data();
+	for(int kb = 0; kb < blocks; ++kb){
+		min_plus_tile(dist, next, stride, kb, kb, kb, unreachable);
+
+		/* The row and the column of the diagonal tile */
+		parallel_for(0, 2 * (blocks - 1), [&](size_t t){
+			int other = t / 2 < (size_t) kb ? t / 2 : t / 2 + 1;
+			if(t % 2 == 0)
+				min_plus_tile(dist, next, stride, kb, other, kb, unreachable);
+			else
+				min_plus_tile(dist, next, stride, other, kb, kb, unreachable);
+		}, 1);
+
+		/* Everything else */
+		parallel_for(0, (blocks - 1) * (blocks - 1), [&](size_t t){
+			int ci = t / (blocks - 1);
+			int cj = t % (blocks - 1);
+			ci += ci >= kb;
+			cj += cj >= kb;
+			min_plus_tile(dist, next, stride, ci, cj, kb, unreachable);
+		}, 1);
+	}
+
+	for(int i = 0; i < n; ++i){
+		if(d[i * stride + i] < 0)
+			throw std::invalid_argument("negative cycle");
+	}
+	parallel_for(0, d.size(), [&](size_t e){
+		if(d[e] >= unreachable)
+			d[e] = numeric_limits<W>::max();
+	});
+	return result;
+}
+
+/*! The transitive closure of a graph as a bit matrix, made by transitive_closure: bit j of row i
+is set if there is a path of one edge or more from the node of dense index i to the one of dense
+index j. Rows are padded to whole 64 bit words. Queries are one load and a mask. */
+template <typename I, typename D>
+struct Reachability{
+
+	/* The Nodes by dense index */
+	vector<NodeSP<I, D>> nodes;
+	FlatHashMap<I, int> index;
+
+	size_t row_words = 0;
+	vector<uint64_t> words;
+
+	inline int size() const {
+		return nodes.size();
+	}
+
+	int index_of(const NodeSP<I, D>& x) const {
+		auto i = index.find(x->get_id());
+		if(i == nullptr)
+			throw std::invalid_argument("node not in the graph");
+		return *i;
+	}
+
+	/*! Checks if there is a path from i to j. Every node reaches itself */
+	inline bool reachable(int i, int j) const {
+		return i == j || (words[i * row_words + (j >> 6)] >> (j & 63) & 1);
+	}
+
+	inline bool reachable(const NodeSP<I, D>& src, const NodeSP<I, D>& dst) const {
+		return reachable(index_of(src), index_of(dst));
+	}
+
+	/*! Checks if i is on a cycle, that is if it reaches itself by one edge or more */
+	inline bool on_cycle(int i) const {
+		return words[i * row_words + (i >> 6)] >> (i & 63) & 1;
+	}
+
+	/*! The number of nodes reachable from i, i not included unless it is on a cycle */
+	size_t reachable_count(int i) const {
+		size_t count = 0;
+		for(size_t w = 0; w < row_words; ++w){
+			count += __builtin_popcountll(words[i * row_words + w]);
+		}
+		return count;
+	}
+};
+
+/*! The transitive closure of the graph, for reachability queries in constant time. The adjacency
+is written in a bit matrix, from the rows of a weighted GraphAM as they are or from the edges of
+other graphs, and closed by Warshall's algorithm one word of k at a time: the 64 rows of the word
+are closed among themselves, then every other row takes in the rows of the k it reaches, a 64 bit
+word per step. The rows are independent in the second step, which runs on num_threads() threads.
+Takes n * n / 8 bytes. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+Reachability<I, D> transitive_closure(const GraphSP<I, W, D, GraphType>& graph){
+
+	Reachability<I, D> result;
+	auto& nodes = result.nodes;
+
+	vector<int> rows;
+	if constexpr(HasAdjacencyMatrix<I, W, D, GraphType>){
+		for(int row = 0; row < graph->matrix_rows(); ++row){
+			auto x = graph->node_of_row(row);
+			if(x != nullptr){
+				rows.push_back(row);
+				nodes.push_back(x);
+			}
+		}
+	}else{
+		nodes = get_nodes(graph);
+	}
+	int n = nodes.size();
+	result.index.reserve(n);
+	for(int i = 0; i < n; ++i){
+		result.index[nodes[i]->get_id()] = i;
+	}
+
+	size_t row_words = (n + 63) / 64;
+	result.row_words = row_words;
+	auto& words = result.words;
+	words.assign(n * row_words, 0);
+
+	if constexpr(HasAdjacencyMatrix<I, W, D, GraphType>){
+		parallel_for(0, n, [&](size_t i){
+			const W * row = graph->matrix_row(rows[i]);
+			uint64_t * out = words.data() + i * row_words;
+			for(int j = 0; j < n; ++j){
+				out[j >> 6] |= (uint64_t) (row[rows[j]] != 0) << (j & 63);
+			}
+		});
+	}else{
+		for(int i = 0; i < n; ++i){
+			for(auto edge : out_edges(graph, nodes[i])){
+				int j = result.index_of(edge.first);
+				words[i * row_words + (j >> 6)] |= (uint64_t) 1 << (j & 63);
+			}
+		}
+	}
+
+	uint64_t * bits = words.data();
+	auto take_in = [&](size_t i, size_t kw){
+		uint64_t * row = bits + i * row_words;
+		int last = min((size_t) n, kw * 64 + 64);
+		for(int k = kw * 64; k < last; ++k){
+			if(!(row[kw] >> (k & 63) & 1))
+				continue;
+			const uint64_t * source = bits + k * row_words;
+			for(size_t w = 0; w < row_words; ++w){
+				row[w] |= source[w];
+			}
+		}
+	};
+
+	for(size_t kw = 0; kw < row_words; ++kw){
+		size_t first = kw * 64;
+		size_t last = min((size_t) n, first + 64);
+
+		/* Rows of the word first. Warshall over its own k closes them */
+		for(size_t k = first; k < last; ++k){
+			const uint64_t * source = bits + k * row_words;
+			for(size_t i = first; i < last; ++i){
+				uint64_t * row = bits + i * row_words;
+				if(row[kw] >> (k & 63) & 1){
+					for(size_t w = 0; w < row_words; ++w){
+						row[w] |= source[w];
+					}
+				}
+			}
+		}
+
+		/* The rows of the word are now as they would be after all its k, which only adds paths
+		that exist, so the other rows can take them in any order */
+		parallel_for(0, n - (last - first), [&](size_t t){
+			take_in(t < first ? t : t + (last - first), kw);
+		});
+	}
+	return result;
+}
+
+/*! A minimum spanning forest of a dense graph, made by kruskal_dense or boruvka_dense. The edges
+are taken as undirected, and kept as their positions in the edge arrays of the graph, in increasing
+order, so the forest costs no Edge objects; spanning_forest_graph makes a graph of them. Edges of
+equal weight are ordered by position, so both algorithms find the same forest. */
+template <typename W>
+struct SpanningForest{
+	vector<size_t> edges;
+	W weight = 0;
+	/* Number of trees, one per weakly connected component */
+	int trees = 0;
+
+	/* Scratch space of the runs: the union-find forest of the nodes, the edges by weight for
+	Kruskal, the lightest edge out of every component and the ones picked for Borůvka */
+	vector<int> component;
+	vector<size_t> order;
+	vector<size_t> lightest;
+	vector<size_t> picked;
+};
+
+/* The node an edge position of a dense graph comes from: the last row that starts at or before it */
+inline int edge_source(const size_t * offsets, int n, size_t e){
+	return upper_bound(offsets, offsets + n + 1, e) - offsets - 1;
+}
+
+/* Sums the weights and counts the trees of a finished forest, and sorts its edges */
+template <typename W>
+void finish_spanning_forest(const W * weights, int n, SpanningForest<W>& result){
+	sort(result.edges.begin(), result.edges.end());
+	result.weight = 0;
+	for(auto e : result.edges){
+		result.weight += weights[e];
+	}
+	result.trees = n - result.edges.size();
+}
+
+/*! Kruskal's minimum spanning forest. The edge positions are sorted by weight with parallel_sort,
+then joined in order in a union-find forest, until it is one tree or the edges run out. Takes a
+size_t per edge for the sort; boruvka_dense does not. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+void kruskal_dense(const GraphSP<I, W, D, GraphType>& graph, SpanningForest<W>& result){
+
+	int n = graph->num_nodes();
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	const W * weights = graph->weight_array();
+	size_t m = offsets[n];
+
+	auto& order = result.order;
+	order.resize(m);
+	parallel_for(0, m, [&](size_t e){
+		order[e] = e;
+	});
+	parallel_sort(order.begin(), order.end(), [weights](size_t a, size_t b){
+		return weights[a] < weights[b] || (weights[a] == weights[b] && a < b);
+	});
+
+	auto& parent = result.component;
+	parent.resize(n);
+	for(int u = 0; u < n; ++u){
+		parent[u] = u;
+	}
+	auto find = [&parent](int u){
+		while(parent[u] != u){
+			parent[u] = parent[parent[u]];
+			u = parent[u];
+		}
+		return u;
+	};
+
+	result.edges.clear();
+	for(size_t k = 0; k < m && (int) result.edges.size() < n - 1; ++k){
+		size_t e = order[k];
+		int u = find(edge_source(offsets, n, e));
+		int v = find(targets[e]);
+		if(u == v)
+			continue;
+		parent[max(u, v)] = min(u, v);
+		result.edges.push_back(e);
+	}
+	finish_spanning_forest(weights, n, result);
+}
+
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline SpanningForest<W> kruskal_dense(const GraphSP<I, W, D, GraphType>& graph){
+	SpanningForest<W> result;
+	kruskal_dense(graph, result);
+	return result;
+}
+
+/*! Borůvka's minimum spanning forest, on num_threads() threads. Every round, the edges between
+two components offer themselves to both with a compare and swap, which leaves the lightest edge out
+of every component; those edges are linked in the union-find forest of connected_components_dense,
+an edge picked from both of its sides once. The number of components at least halves every round.
+Needs no memory per edge. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+void boruvka_dense(const GraphSP<I, W, D, GraphType>& graph, SpanningForest<W>& result){
+
+	int n = graph->num_nodes();
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	const W * weights = graph->weight_array();
+	const size_t none = numeric_limits<size_t>::max();
+
+	auto& component = result.component;
+	component.resize(n);
+	for(int u = 0; u < n; ++u){
+		component[u] = u;
+	}
+	result.lightest.assign(n, none);
+	result.picked.resize(n);
+	int * c = component.data();
+	size_t * lightest = result.lightest.data();
+	size_t * picked = result.picked.data();
+
+	auto offer = [&](int root, size_t e){
+		size_t current = __atomic_load_n(lightest + root, __ATOMIC_RELAXED);
+		while(current == none || weights[e] < weights[current] ||
+			(weights[e] == weights[current] && e < current)){
+			if(__atomic_compare_exchange_n(lightest + root, &current, e, false,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		}
+	};
+
+	result.edges.clear();
+	while(true){
+		parallel_for(0, n, [&](size_t u){
+			int cu = c[u];
+			for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+				int cv = c[targets[e]];
+				if(cu != cv){
+					offer(cu, e);
+					offer(cv, e);
+				}
+			}
+		});
+
+		/* The lightest edge of two components is picked by the smaller one */
+		parallel_for(0, n, [&](size_t root){
+			size_t e = lightest[root];
+			picked[root] = none;
+			if(e == none)
+				return;
+			int cu = c[edge_source(offsets, n, e)];
+			int cv = c[targets[e]];
+			int other = cu == (int) root ? cv : cu;
+			if(lightest[other] != e || (int) root < other)
+				picked[root] = e;
+		});
+
+		size_t before = result.edges.size();
+		for(int root = 0; root < n; ++root){
+			if(picked[root] != none)
+				result.edges.push_back(picked[root]);
+			lightest[root] = none;
+		}
+		if(result.edges.size() == before)
+			break;
+
+		parallel_for(before, result.edges.size(), [&](size_t k){
+			size_t e = result.edges[k];
+			link_components(c, edge_source(offsets, n, e), targets[e]);
+		});
+		compress_components(c, n);
+	}
+	finish_spanning_forest(weights, n, result);
+}
+
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline SpanningForest<W> boruvka_dense(const GraphSP<I, W, D, GraphType>& graph){
+	SpanningForest<W> result;
+	boruvka_dense(graph, result);
+	return result;
+}
+
+/* Builds a spanning forest as a TreeType graph, see spanning_forest_graph */
+template <template <typename, typename, typename> typename TreeType, typename I, typename W, typename D,
+	template <typename, typename, typename> typename GraphType>
+shared_ptr<TreeType<I, W, D>> build_spanning_forest(const GraphSP<I, W, D, GraphType>& graph,
+	const SpanningForest<W>& forest){
+
+	int n = graph->num_nodes();
+	const size_t * offsets = graph->offset_array();
+	const int * targets = graph->target_array();
+	const W * weights = graph->weight_array();
+
+	auto tree = create_graph<I, W, D, TreeType>();
+	vector<NodeSP<I, D>> nodes;
+	for(int u = 0; u < n; ++u){
+		nodes.push_back(graph->node_at(u));
+	}
+	vector<EdgeRecord<I, W>> records;
+	for(auto e : forest.edges){
+		records.push_back(EdgeRecord<I, W>{graph->node_at(edge_source(offsets, n, e))->get_id(), weights[e],
+			graph->node_at(targets[e])->get_id()});
+	}
+	add_nodes(tree, nodes);
+	add_edges(tree, records);
+	return tree;
+}
+
+/*! Materializes a spanning forest as a Graph: all the Nodes, and every edge of the forest in the
+direction it has in graph */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsDenseGraph<I, W, D, GraphType>
+inline ResultGraphSP<I, W, D, GraphType> spanning_forest_graph(const GraphSP<I, W, D, GraphType>& graph,
+	const SpanningForest<W>& forest){
+	return build_spanning_forest<result_graph<GraphType>::template type>(graph, forest);
+}
+
+/*! The minimum spanning forest of a mutable graph, its edges taken as undirected. Freezes the graph,
+runs boruvka_dense and returns the forest with all the Nodes of graph. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+ResultGraphSP<I, W, D, GraphType> minimum_spanning_forest(const GraphSP<I, W, D, GraphType>& graph){
+	auto frozen = freeze_graph(graph);
+	auto forest = boruvka_dense(frozen);
+	return build_spanning_forest<result_graph<GraphType>::template type>(frozen, forest);
+}
 
 #endif
\ No newline at end of file
@@ -2,11 +2,13 @@
 #define GRAPH_H
 
 #include <iostream>
+#include <atomic>
 #include "graph_concepts.h"
 #include "Edge.h"
 #include "Node.h"
 #include "GraphAL.h"
 #include "GraphAM.h"
+#include "GraphCSR.h"
 
 using namespace std;
 
@@ -76,25 +78,72 @@ void print_edges(vector<shared_ptr<Edge<IdType, WeightType, DataType>>>& edges){
 	cout << endl;
 }
 
-/*! Utility function that adds all Nodes in the input vector to the given graph */
+/*! Utility function that adds all Nodes in the input vector to the given graph. Graphs with a
+bulk loading path add the whole batch at once, and add nothing if one of the Nodes is already in
+the graph */
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
 requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
 inline void add_nodes(shared_ptr<GraphType<I, W, D>> g, const vector<shared_ptr<Node<I, D>>>& node_ps){
 
-	for(auto node_p : node_ps){
-		add_node(g, node_p);
+	if constexpr(HasBulkLoad<I, W, D, GraphType>){
+		g->add_nodes(node_ps);
+	}else{
+		for(auto node_p : node_ps){
+			add_node(g, node_p);
+		}
 	}
 
 	return;
 }
 
-/*! Utility function that adds all Edges in the input vector to the given graph */
+/*! Utility function that adds all Edges in the input vector to the given graph. Graphs with a
+bulk loading path add the whole batch at once, see add_edges for EdgeRecords. As with add_edge, an
+Edge that is already in the graph or repeated in the batch is an error */
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
 requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
 inline void add_edges(shared_ptr<GraphType<I, W, D>> g, const vector<shared_ptr<Edge<I, W, D>>>& edge_ps){
 
-	for(auto edge_p : edge_ps){
-		add_edge(g, edge_p);
+	if constexpr(HasBulkLoad<I, W, D, GraphType>){
+		vector<EdgeRecord<I, W>> records;
+		records.reserve(edge_ps.size());
+		for(auto& edge_p : edge_ps){
+			records.push_back(EdgeRecord<I, W>{edge_p->get_src()->get_id(), edge_p->get_weight(),
+				edge_p->get_dst()->get_id()});
+		}
+		g->add_edges(records, false);
+	}else{
+		for(auto edge_p : edge_ps){
+			add_edge(g, edge_p);
+		}
+	}
+
+	return;
+}
+
+/*! Adds all the (src id, weight, dst id) records to the given graph. This is the fast way to load
+many edges: no Edge objects are created and, for graphs with a bulk loading path, the batch is
+sorted and validated once. If one of the edges cannot be added, an exception is thrown and none
+of them are. Loading through a graph without the bulk path stops at the first bad edge. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+inline void add_edges(shared_ptr<GraphType<I, W, D>> g, const vector<EdgeRecord<I, W>>& records){
+
+	if constexpr(HasBulkLoad<I, W, D, GraphType>){
+		g->add_edges(records);
+	}else{
+		/* Without the bulk path the ids are resolved against the nodes of the graph, once */
+		map<I, shared_ptr<Node<I, D>>> nodes;
+		for(auto& node_p : g->get_nodes()){
+			nodes[node_p->get_id()] = node_p;
+		}
+		for(auto& record : records){
+			auto src = nodes.find(record.src);
+			auto dst = nodes.find(record.dst);
+			if(src == nodes.end() || dst == nodes.end()){
+				throw std::invalid_argument("src or dst of the edge not in the graph");
+			}
+			g->add_edge(create_edge<I, W, D>(src->second, record.weight, dst->second));
+		}
 	}
 
 	return;
@@ -113,21 +162,21 @@ using GraphSP = shared_ptr<GraphType<I, W, D>>;
 
 /*! Implementation independent function checks if the Node x is a member of the Graph graph. */ 
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
 inline bool has_node(const GraphSP<I, W, D, GraphType> graph, const NodeSP<I, D> x){
 	return graph->has_node(x);
 }
 
 /*! Implementation independent function checks if the Edge e is a member of the Graph graph. */ 
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
 inline bool has_edge(const GraphSP<I, W, D, GraphType> graph, EdgeSP<I, W, D> e){
 	return graph->has_edge(e->get_src(), e->get_weight(), e->get_dst());
 }
 
 /*! Implementation independent function checks if the Edge e is a member of the Graph graph. */ 
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
 inline bool has_edge(const GraphSP<I, W, D, GraphType> graph, const NodeSP<I, D> src, const W w, 
 		const NodeSP<I, D> dst){
 	return graph->has_edge(src, w, dst);
@@ -135,7 +184,7 @@ inline bool has_edge(const GraphSP<I, W, D, GraphType> graph, const NodeSP<I, D>
 
 /*! Implementation independent function returns a vector of Edges of Node x in graph. */ 
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
 inline vector<EdgeSP<I, W, D>> edges_of_node(const GraphSP<I, W, D, GraphType> graph,
 	const NodeSP<I, D> x){
 	return graph->edges_of_node(x);
@@ -143,36 +192,85 @@ inline vector<EdgeSP<I, W, D>> edges_of_node(const GraphSP<I, W, D, GraphType> g
 
 /*! Implementation independent function returns a vector of all Edges in graph. */ 
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
 inline vector<EdgeSP<I, W, D>> get_edges(const GraphSP<I, W, D, GraphType> graph){
 	return graph->get_edges();
 }
 
+/*! Same as edges_of_node, but returns EdgeRefs: no Edge objects are created and no reference counts
+are touched. Use EdgeRef::to_edge for the Edges that need to outlive the nodes. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+inline vector<EdgeRef<I, W, D>> edge_refs_of_node(const GraphSP<I, W, D, GraphType> graph,
+	const NodeSP<I, D> x){
+	return graph->edge_refs_of_node(x);
+}
+
+/*! Same as get_edges, but returns EdgeRefs in one contiguous array, see edge_refs_of_node */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+inline vector<EdgeRef<I, W, D>> edge_refs(const GraphSP<I, W, D, GraphType> graph){
+	return graph->edge_refs();
+}
+
 /*! Implementation independent function returns the Edge object that representing the Edge between src and
 dst in graph */ 
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
 inline EdgeSP<I, W, D> get_edge(const GraphSP<I, W, D, GraphType> graph, NodeSP<I, D> src, NodeSP<I, D> dst){
 	return graph->get_edge(src, dst);
 }
 
 /*! Implementation independent function returns a vector of all Nodes in graph. */ 
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
 inline vector<NodeSP<I, D>> get_nodes(const GraphSP<I, W, D, GraphType> graph){
 	return graph->get_nodes();
 }
 
 /*! Implementation independent function returns a vector of Nodes adjacent to node src in graph. */ 
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
 inline vector<NodeSP<I, D>> neighbours(const GraphSP<I, W, D, GraphType> graph, const NodeSP<I, D> src){
 	return graph->neighbours(src);
 }
 
+/*! Implementation independent function returns a Range over the Nodes adjacent to node src in graph. 
+Unlike neighbours, nothing is copied: the Range walks the storage of the graph in place and is invalidated 
+by any change to the graph. */ 
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+inline auto neighbours_view(const GraphSP<I, W, D, GraphType>& graph, const NodeSP<I, D>& src){
+	return graph->neighbours_view(src);
+}
+
+/*! Implementation independent function returns a Range over the outgoing edges of node src in graph,
+as (dst, weight) pairs. Same lifetime rules as neighbours_view. */ 
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+inline auto out_edges(const GraphSP<I, W, D, GraphType>& graph, const NodeSP<I, D>& src){
+	return graph->out_edges(src);
+}
+
+/*! Implementation independent function returns a vector of Nodes that have an edge to node dst in graph. 
+Only implementations that track in-edges provide it, see GraphAL::track_in_edges. */ 
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && HasInEdges<I, W, D, GraphType>
+inline vector<NodeSP<I, D>> predecessors(const GraphSP<I, W, D, GraphType> graph, const NodeSP<I, D> dst){
+	return graph->predecessors(dst);
+}
+
+/*! Implementation independent function returns a Range over the incoming edges of node dst in graph,
+as (src, weight) pairs. Same lifetime rules as neighbours_view. */ 
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && HasInEdges<I, W, D, GraphType>
+inline auto in_edges(const GraphSP<I, W, D, GraphType>& graph, const NodeSP<I, D>& dst){
+	return graph->in_edges(dst);
+}
+
 /*! Implementation independent function returns boolean value reflecting the adjacency of src and dst in graph */ 
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
 inline bool adjacent(const GraphSP<I, W, D, GraphType> graph, 
 	const NodeSP<I, D> src, 
 	const NodeSP<I, D> dst){
@@ -254,65 +352,208 @@ inline bool operator!=(const EdgeSP<I, W, D> lhs,
 	return !(lhs == rhs);
 }
 
+/*! The order independent fingerprint of the nodes and edges of the graph, see node_fingerprint.
+Graphs that keep it up to date return it at once, the others are walked. Equal graphs have equal
+fingerprints, so graphs with different fingerprints are different; equal fingerprints are very
+likely, but not certainly, equal graphs. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+uint64_t fingerprint(const GraphSP<I, W, D, GraphType>& graph){
+
+	if constexpr(HasFingerprint<I, W, D, GraphType>){
+		return graph->fingerprint();
+	}else{
+		uint64_t sum = 0;
+		for(auto& x : get_nodes(graph)){
+			sum += node_fingerprint(x->get_id());
+		}
+		for(auto& edge : edge_refs(graph)){
+			sum += edge_fingerprint(edge.get_src()->get_id(), edge.get_weight(), edge.get_dst()->get_id());
+		}
+		return sum;
+	}
+}
+
+/* Checks that the nodes of g1 are the nodes of g2, and puts them in nodes. Ids are unique, so
+same size and inclusion will do */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+bool same_nodes(const GraphSP<I, W, D, GraphType>& g1, const GraphSP<I, W, D, GraphType>& g2,
+	vector<NodeSP<I, D>>& nodes){
+
+	if(g1->num_nodes() != g2->num_nodes())
+		return false;
+	nodes = get_nodes(g1);
+	for(auto& x : nodes){
+		if(!has_node(g2, x))
+			return false;
+	}
+	return true;
+}
+
+/* Checks that the nodes from first to last have the same out-edges in both graphs, by sorting
+the out-edges of every node by destination. Assumes both graphs have the nodes */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
+bool same_out_edges(const GraphSP<I, W, D, GraphType>& g1, const GraphSP<I, W, D, GraphType>& g2,
+	const vector<NodeSP<I, D>>& nodes, size_t first, size_t last){
+
+	vector<pair<I, W>> edges_of_g1, edges_of_g2;
+	auto by_dst = [](const pair<I, W>& a, const pair<I, W>& b){ return a.first < b.first; };
+
+	for(size_t i = first; i < last; ++i){
+		edges_of_g1.clear();
+		edges_of_g2.clear();
+		for(auto edge : out_edges(g1, nodes[i])){
+			edges_of_g1.push_back(make_pair(edge.first->get_id(), edge.second));
+		}
+		for(auto edge : out_edges(g2, nodes[i])){
+			edges_of_g2.push_back(make_pair(edge.first->get_id(), edge.second));
+		}
+		if(edges_of_g1.size() != edges_of_g2.size())
+			return false;
+
+		/* A node has at most one edge to every other node */
+		sort(edges_of_g1.begin(), edges_of_g1.end(), by_dst);
+		sort(edges_of_g2.begin(), edges_of_g2.end(), by_dst);
+		if(edges_of_g1 != edges_of_g2)
+			return false;
+	}
+	return true;
+}
+
 /* Comparison of graphs using (==) */
 /*! Two graphs, G = (V, E) and G' = (V', E'), are equal if V == V' and E == E'. NOTE: this is different
-from checking for isomorphism between G and G'! */
+from checking for isomorphism between G and G'! Graphs with fingerprints that differ are told apart at
+once. Otherwise the nodes of G are looked up in G', and the out-edges of every node are sorted by
+destination and compared, so the comparison is linear in the size of the graphs up to the sorts. To
+compare large graphs on several threads, see parallel_equal in algo.h */
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-//requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+requires Comparable<I> && Numeric<W> && IsReadableGraph<I, W, D, GraphType>
 inline bool operator==(const GraphSP<I, W, D, GraphType> g1, const GraphSP<I, W, D, GraphType> g2){
 
-	auto nodes_of_g1 = get_nodes(g1);
-	auto nodes_of_g2 = get_nodes(g2);
-
-	/* TODO: accelerate this maybe by sorting the nodes first?*/
-	/* Lets compare the node sets first */
-	for(auto node_of_g1 : nodes_of_g1){
-		
-		auto it = std::find(nodes_of_g2.begin(), nodes_of_g2.end(), node_of_g1);
-		if(it != nodes_of_g2.end()){
-			std::swap(*it, nodes_of_g2.back());
-			nodes_of_g2.pop_back();
-		}else{
+	if constexpr(HasFingerprint<I, W, D, GraphType>){
+		if(g1->fingerprint() != g2->fingerprint())
 			return false;
+	}
+
+	vector<NodeSP<I, D>> nodes;
+	if(!same_nodes(g1, g2, nodes))
+		return false;
+	return same_out_edges(g1, g2, nodes, 0, nodes.size());
+}
+
+/* COPY functions */
+/*! Function returns a copy of the graph that shares its Nodes. Graphs that can clone their storage
+copy it directly, see HasClone; the others are rebuilt through the bulk loading path from the
+EdgeRefs of the graph, so no Edge is created either way */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+inline shared_ptr<GraphType<I, W, D>> copy_graph(const GraphSP<I, W, D, GraphType> g){
+
+	if constexpr(HasClone<I, W, D, GraphType>){
+		return g->clone();
+	}else{
+		auto g_copy = create_graph<I, W, D, GraphType>();
+		add_nodes(g_copy, get_nodes(g));
+
+		auto refs = edge_refs(g);
+		vector<EdgeRecord<I, W>> records;
+		records.reserve(refs.size());
+		for(auto& ref : refs){
+			records.push_back(EdgeRecord<I, W>{ref.get_src()->get_id(), ref.get_weight(), ref.get_dst()->get_id()});
 		}
+		add_edges(g_copy, records);
 
+		return g_copy;
 	}
-	if(nodes_of_g2.size()){
-		return false;
+}
+
+/*! A copy-on-write handle to a graph. Copies of a handle share one graph until one of them
+writes: write() gives the handle its own copy_graph of the graph the first time it is called while
+other handles share it, and returns the graph the handle owns from then on. read() never copies.
+The handles count themselves, so keeping the pointer returned by read() or write() does not make
+the graph shared, and a pointer from write() goes on reaching the graph of its handle. Do not change
+the graph through read(), nor through a pointer from write() once the handle has been copied: the
+other handles would see it. Handles can be copied and written from different threads, one handle
+from one thread at a time */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+class CopyOnWrite{
+
+public:
+
+	CopyOnWrite(const GraphSP<I, W, D, GraphType> graph) : state(make_shared<shared_graph>(graph)) {}
+
+	CopyOnWrite(const CopyOnWrite& other) : state(other.state) {
+		state->handles.fetch_add(1);
 	}
 
-	/* Lets compare the edge sets now */
-	auto edges_of_g1 = get_edges(g1);
-	auto edges_of_g2 = get_edges(g2);
+	CopyOnWrite& operator=(const CopyOnWrite& other){
+		if(state != other.state){
+			other.state->handles.fetch_add(1);
+			leave();
+			state = other.state;
+		}
+		return *this;
+	}
 
+	~CopyOnWrite(){
+		leave();
+	}
 
-	for(auto edge_of_g1 : edges_of_g1){
-		
-		auto it = std::find(edges_of_g2.begin(), edges_of_g2.end(), edge_of_g1);
-		if(it != edges_of_g2.end()){
-			std::swap(*it, edges_of_g2.back());
-			edges_of_g2.pop_back();
-		}else{
-			return false;
+	/*! The graph, for reading */
+	inline const GraphSP<I, W, D, GraphType>& read() const {
+		return state->graph;
+	}
+
+	/*! The graph, for writing. Copies it first if other handles share it */
+	const GraphSP<I, W, D, GraphType>& write(){
+		if(shared()){
+			auto own = make_shared<shared_graph>(copy_graph<I, W, D, GraphType>(state->graph));
+			leave();
+			state = own;
 		}
+		return state->graph;
 	}
-	if(edges_of_g2.size()){
-		return false;
+
+	/*! Checks if other handles share the graph, i.e. if the next write copies it */
+	inline bool shared() const {
+		return state->handles.load() > 1;
 	}
 
-	return true;
-}
+private:
 
-/* COPY functions */
+	/* The graph with the number of handles to it */
+	struct shared_graph{
+		shared_graph(const GraphSP<I, W, D, GraphType>& graph) : graph(graph), handles(1) {}
+
+		GraphSP<I, W, D, GraphType> graph;
+		std::atomic<long> handles;
+	};
+
+	shared_ptr<shared_graph> state;
+
+	inline void leave(){
+		state->handles.fetch_sub(1);
+	}
+};
+
+/*! Function starts copy-on-write sharing of the graph, see CopyOnWrite */
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
 requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
-inline shared_ptr<GraphType<I, W, D>> copy_graph(const GraphSP<I, W, D, GraphType> g){
-	
-	auto g_copy = create_graph<I, W, D, GraphType>();
-	add_nodes(g_copy, get_nodes(g));
-	add_edges(g_copy, get_edges(g));
+inline CopyOnWrite<I, W, D, GraphType> copy_on_write(const GraphSP<I, W, D, GraphType> graph){
+	return CopyOnWrite<I, W, D, GraphType>(graph);
+}
 
-	return g_copy;
+/* FREEZE functions */
+/*! Function builds an immutable GraphCSR snapshot of the graph. The snapshot does not follow
+later changes to g, freeze again to pick them up. With with_in_edges set the snapshot also stores
+the transpose, for predecessors, in_edges and the algorithms that pull along in-edges. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+inline shared_ptr<GraphCSR<I, W, D>> freeze_graph(const GraphSP<I, W, D, GraphType> g, bool with_in_edges = false){
+	return GraphCSR<I, W, D>::create_graph(*g, with_in_edges);
 }
 
 
@@ -22,6 +22,10 @@ template <typename IdType, typename DataType>
 class Node;
 template <typename IdType, typename WeightType, typename DataType>
 class Edge;
+template <typename IdType, typename WeightType>
+struct EdgeRecord;
+template <typename IdType, typename WeightType, typename DataType>
+struct EdgeRef;
 
 
 template<typename IdType>
@@ -45,23 +49,53 @@ requires (WeightType w1, WeightType w2) {
 	{ w1 % w2 } -> WeightType;
 };
 
+/*! The read-only half of the graph interface. Immutable implementations, such as GraphCSR,
+provide only these functions. */
 template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
-concept bool IsGraph = 
+concept bool IsReadableGraph = 
 requires (GraphType<I, W, D> g, 
 	shared_ptr<Node<I, D>> n1, 
 	shared_ptr<Node<I, D>> n2, 
-	shared_ptr<Edge<I, W, D>> e,
 	W w){
 
 	{ g.has_node(n1) } -> bool;
-	{ g.create_graph() } -> shared_ptr<GraphType<I, W, D>>;
 	{ g.has_edge(n1, w, n2) } -> bool;
 	{ g.edges_of_node(n1) } -> vector<shared_ptr<Edge<I, W, D>>>;
 	{ g.get_edges() } -> vector<shared_ptr<Edge<I, W, D>>>;
 	{ g.get_edge(n1, n2)} -> shared_ptr<Edge<I, W, D>>;
+	{ g.edge_refs_of_node(n1) } -> vector<EdgeRef<I, W, D>>;
+	{ g.edge_refs() } -> vector<EdgeRef<I, W, D>>;
 	{ g.get_nodes()} -> vector<shared_ptr<Node<I, D>>>;
+	{ g.num_nodes() } -> int;
 	{ g.neighbours(n1)} -> vector<shared_ptr<Node<I, D>>>;
 	{ g.adjacent(n1, n2)} -> bool;
+	{ *g.neighbours_view(n1).begin() } -> shared_ptr<Node<I, D>>;
+	{ (*g.out_edges(n1).begin()).first } -> shared_ptr<Node<I, D>>;
+	{ (*g.out_edges(n1).begin()).second } -> W;
+
+};
+
+/*! Graphs that can also answer queries about the incoming edges of a node */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+concept bool HasInEdges = 
+requires (GraphType<I, W, D> g, 
+	shared_ptr<Node<I, D>> n1){
+
+	{ g.predecessors(n1)} -> vector<shared_ptr<Node<I, D>>>;
+	{ (*g.in_edges(n1).begin()).first } -> shared_ptr<Node<I, D>>;
+	{ (*g.in_edges(n1).begin()).second } -> W;
+
+};
+
+/*! The full graph interface: the read-only half plus creation and mutation. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+concept bool IsGraph = IsReadableGraph<I, W, D, GraphType> &&
+requires (GraphType<I, W, D> g, 
+	shared_ptr<Node<I, D>> n1, 
+	shared_ptr<Node<I, D>> n2, 
+	shared_ptr<Edge<I, W, D>> e){
+
+	{ g.create_graph() } -> shared_ptr<GraphType<I, W, D>>;
 	{ g.add_node(n1)} -> bool;
 	{ g.remove_node(n1)} -> bool;
 	{ g.add_edge(e)} -> bool;
@@ -69,4 +103,86 @@ requires (GraphType<I, W, D> g,
 
 };
 
+/*! Graphs that can load a whole batch of nodes or edges at once, validating the batch up front */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+concept bool HasBulkLoad = 
+requires (GraphType<I, W, D> g, 
+	vector<shared_ptr<Node<I, D>>> ns, 
+	vector<EdgeRecord<I, W>> es){
+
+	{ g.add_nodes(ns)} -> bool;
+	{ g.add_edges(es)} -> bool;
+
+};
+
+/*! Graphs that expose their adjacency as dense compressed sparse row arrays, such as GraphCSR.
+Algorithms that work on dense indices take these */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+concept bool IsDenseGraph = IsReadableGraph<I, W, D, GraphType> &&
+requires (GraphType<I, W, D> g, 
+	shared_ptr<Node<I, D>> n1, 
+	int i){
+
+	{ g.num_nodes() } -> int;
+	{ g.num_edges() } -> size_t;
+	{ g.index_of(n1) } -> int;
+	{ g.node_at(i) } -> shared_ptr<Node<I, D>>;
+	{ g.offset_array() } -> const size_t *;
+	{ g.target_array() } -> const int *;
+	{ g.weight_array() } -> const W *;
+
+};
+
+/*! Dense graphs that can also store their transpose, see GraphCSR::has_in_edges */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+concept bool HasDenseInEdges = IsDenseGraph<I, W, D, GraphType> &&
+requires (GraphType<I, W, D> g){
+
+	{ g.has_in_edges() } -> bool;
+	{ g.in_offset_array() } -> const size_t *;
+	{ g.source_array() } -> const int *;
+	{ g.in_weight_array() } -> const W *;
+
+};
+
+/*! Graphs that store their adjacency as a dense matrix, such as GraphAM. Algorithms that work
+on the whole matrix copy its rows instead of walking the edges */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+concept bool HasAdjacencyMatrix = IsReadableGraph<I, W, D, GraphType> &&
+requires (GraphType<I, W, D> g, 
+	int i){
+
+	{ g.matrix_rows() } -> int;
+	{ g.matrix_row(i) } -> const W *;
+	{ g.node_of_row(i) } -> shared_ptr<Node<I, D>>;
+
+};
+
+/*! Graphs that keep a fingerprint of their contents up to date as they change */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+concept bool HasFingerprint = IsReadableGraph<I, W, D, GraphType> &&
+requires (GraphType<I, W, D> g){
+
+	{ g.fingerprint() } -> uint64_t;
+
+};
+
+/*! Graphs that can copy their own storage, see copy_graph */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+concept bool HasClone = IsGraph<I, W, D, GraphType> &&
+requires (GraphType<I, W, D> g){
+
+	{ g.clone() } -> shared_ptr<GraphType<I, W, D>>;
+
+};
+
+/*! Algorithms that return a graph, such as the dfs and bfs trees, build it in the implementation
+given by this trait. Mutable implementations build results in their own type, immutable ones
+specialize it. */
+template <template <typename, typename, typename> typename GraphType>
+struct result_graph{
+	template <typename I, typename W, typename D>
+	using type = GraphType<I, W, D>;
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,169 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+/*! This is a supporting class for the algorithms. It is an indexed d-ary min-heap over the
+indices 0 to n - 1: every index is in the heap at most once, with a key, and its key can be
+decreased in place. The entries are stored with their keys, and a node of the heap has Arity
+children, so a sift is log_Arity(size) steps over mostly contiguous memory. */
+template <typename KeyType, int Arity = 4>
+class IndexedHeap{
+
+public:
+
+	IndexedHeap(int n = 0){
+		resize(n);
+	}
+
+	/*! Empties the heap and makes room for the indices 0 to n - 1 */
+	void resize(int n){
+		entries.clear();
+		position.assign(n, -1);
+	}
+
+	/*! Empties the heap. Only the entries left in the heap are touched */
+	void clear(){
+		for(auto& entry : entries){
+			position[entry.second] = -1;
+		}
+		entries.clear();
+	}
+
+	inline bool empty() const {
+		return entries.empty();
+	}
+
+	inline size_t size() const {
+		return entries.size();
+	}
+
+	/*! The number of indices the heap has room for, see resize */
+	inline size_t capacity() const {
+		return position.size();
+	}
+
+	/*! Checks if the index is in the heap */
+	inline bool contains(int i) const {
+		return position[i] != -1;
+	}
+
+	/*! Returns the key of an index in the heap */
+	inline const KeyType& key_of(int i) const {
+		return entries[position[i]].first;
+	}
+
+	/*! Returns the index with the smallest key */
+	inline int top() const {
+		return entries.front().second;
+	}
+
+	/*! Returns the smallest key */
+	inline const KeyType& top_key() const {
+		return entries.front().first;
+	}
+
+	/*! Adds the index with the given key. Throws if the index is already in the heap */
+	void push(int i, const KeyType& key){
+		if(contains(i)){
+			throw std::invalid_argument("index already in the heap");
+		}
+		entries.push_back(std::make_pair(key, i));
+		position[i] = entries.size() - 1;
+		sift_up(entries.size() - 1);
+	}
+
+	/*! Lowers the key of an index in the heap. Throws if the index is not in the heap, or if the
+	new key is larger */
+	void decrease_key(int i, const KeyType& key){
+		if(!contains(i)){
+			throw std::invalid_argument("index not in the heap");
+		}
+		if(entries[position[i]].first < key){
+			throw std::invalid_argument("key is larger than the current one");
+		}
+		entries[position[i]].first = key;
+		sift_up(position[i]);
+	}
+
+	/*! Adds the index, or lowers its key if it is in the heap with a larger one. Returns false
+	if the index is in the heap with a key that is not larger */
+	bool push_or_decrease(int i, const KeyType& key){
+		if(!contains(i)){
+			push(i, key);
+			return true;
+		}
+		if(!(key < entries[position[i]].first))
+			return false;
+		entries[position[i]].first = key;
+		sift_up(position[i]);
+		return true;
+	}
+
+	/*! Removes and returns the index with the smallest key */
+	int pop(){
+		int i = entries.front().second;
+		position[i] = -1;
+
+		if(entries.size() > 1){
+			entries.front() = entries.back();
+			position[entries.front().second] = 0;
+			entries.pop_back();
+			sift_down(0);
+		}else{
+			entries.pop_back();
+		}
+		return i;
+	}
+
+private:
+
+	/* The heap, as (key, index) pairs */
+	std::vector<std::pair<KeyType, int>> entries;
+	/* Where every index is in entries, -1 if it is not in the heap */
+	std::vector<int> position;
+
+	void sift_up(size_t slot){
+		auto entry = entries[slot];
+		while(slot > 0){
+			size_t parent = (slot - 1) / Arity;
+			if(!(entry.first < entries[parent].first))
+				break;
+			entries[slot] = entries[parent];
+			position[entries[slot].second] = slot;
+			slot = parent;
+		}
+		entries[slot] = entry;
+		position[entry.second] = slot;
+	}
+
+	void sift_down(size_t slot){
+		auto entry = entries[slot];
+		size_t size = entries.size();
+		while(true){
+			size_t first = slot * Arity + 1;
+			if(first >= size)
+				break;
+
+			/* Smallest of the children */
+			size_t last = first + Arity < size ? first + Arity : size;
+			size_t smallest = first;
+			for(size_t child = first + 1; child < last; ++child){
+				if(entries[child].first < entries[smallest].first)
+					smallest = child;
+			}
+
+			if(!(entries[smallest].first < entry.first))
+				break;
+			entries[slot] = entries[smallest];
+			position[entries[slot].second] = slot;
+			slot = smallest;
+		}
+		entries[slot] = entry;
+		position[entry.second] = slot;
+	}
+
+};
+#endif
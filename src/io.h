@@ -0,0 +1,442 @@
+#ifndef IO_H
+#define IO_H
+
+#include "gcore.h"
+#include "parallel.h"
+
+#include <string>
+#include <cctype>
+#include <charconv>
+#include <type_traits>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*! \file */
+
+/*! A read-only memory mapping of a whole file. The importers parse the mapping in place,
+so a file is never copied into a buffer. */
+class MappedFile{
+
+public:
+
+	MappedFile(const string& path){
+		int fd = open(path.c_str(), O_RDONLY);
+		if(fd < 0){
+			throw std::invalid_argument("cannot open " + path);
+		}
+
+		struct stat info;
+		if(fstat(fd, &info) != 0){
+			close(fd);
+			throw std::invalid_argument("cannot open " + path);
+		}
+
+		length = info.st_size;
+		data = nullptr;
+		if(length > 0){
+			void * mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(mapped == MAP_FAILED){
+				close(fd);
+				throw std::invalid_argument("cannot map " + path);
+			}
+			madvise(mapped, length, MADV_SEQUENTIAL);
+			data = (const char*) mapped;
+		}
+		close(fd);
+	}
+
+	~MappedFile(){
+		if(data != nullptr)
+			munmap((void*) data, length);
+	}
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	inline const char* begin() const {
+		return data;
+	}
+
+	inline const char* end() const {
+		return data + length;
+	}
+
+	inline size_t size() const {
+		return length;
+	}
+
+private:
+	const char* data;
+	size_t length;
+};
+
+/*! The contents of an edge list file: the ids of all the nodes, and the edges between them */
+template <typename IdType, typename WeightType>
+struct EdgeList{
+	vector<IdType> nodes;
+	vector<EdgeRecord<IdType, WeightType>> edges;
+};
+
+
+/*                          PARSING HELPERS                              */
+
+/* Moves p over spaces and tabs, but not over the end of the line */
+inline void parse_skip_blanks(const char*& p, const char* end){
+	while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')){
+		++p;
+	}
+}
+
+/* True if only blanks are left on the line */
+inline bool parse_at_line_end(const char*& p, const char* end){
+	parse_skip_blanks(p, end);
+	return p == end;
+}
+
+/* Parses the next number of the line into out and moves p past it. Integral types also
+accept a number written with a fraction or an exponent, which is then truncated */
+template <typename T>
+inline void parse_number(const char*& p, const char* end, T& out){
+	parse_skip_blanks(p, end);
+
+	auto result = from_chars(p, end, out);
+	if(result.ec != std::errc()){
+		throw std::invalid_argument("malformed line in edge list");
+	}
+
+	if constexpr(is_integral<T>::value){
+		if(result.ptr < end && (*result.ptr == '.' || *result.ptr == 'e' || *result.ptr == 'E')){
+			double value;
+			result = from_chars(p, end, value);
+			if(result.ec != std::errc()){
+				throw std::invalid_argument("malformed line in edge list");
+			}
+			out = (T) value;
+		}
+	}
+	p = result.ptr;
+}
+
+/* Parses a node id, the files number their nodes with integers */
+template <typename IdType>
+inline IdType parse_id(const char*& p, const char* end){
+	long long id;
+	parse_number(p, end, id);
+	return (IdType) id;
+}
+
+/* Returns the start of the line after the one p is on */
+inline const char* parse_next_line(const char* p, const char* end){
+	auto eol = (const char*) memchr(p, '\n', end - p);
+	return eol == nullptr ? end : eol + 1;
+}
+
+/* Splits [begin, end) into chunks at line boundaries and calls parse_line(line_begin, line_end, records)
+on every line, with the chunks parsed in parallel. parse_line returns true for lines holding an entry,
+the count of those goes into entries. The records come out in file order */
+template <typename IdType, typename WeightType, typename LineParser>
+vector<EdgeRecord<IdType, WeightType>> parse_lines(const char* begin, const char* end,
+	LineParser parse_line, size_t& entries){
+
+	const size_t CHUNK_BYTES = 1 << 20;
+	size_t length = end - begin;
+	size_t chunks = std::max((size_t) 1, std::min(length / CHUNK_BYTES, (size_t) num_threads() * 4));
+
+	/* Chunk c is [bounds[c], bounds[c + 1]), every bound but the first is the start of a line */
+	vector<const char*> bounds(chunks + 1);
+	bounds[0] = begin;
+	bounds[chunks] = end;
+	for(size_t c = 1; c < chunks; ++c){
+		auto guess = std::max(begin + c * (length / chunks), bounds[c - 1]);
+		bounds[c] = guess == begin ? begin : parse_next_line(guess - 1, end);
+	}
+
+	vector<vector<EdgeRecord<IdType, WeightType>>> parts(chunks);
+	vector<size_t> counts(chunks, 0);
+	parallel_for(0, chunks, [&](size_t c){
+		auto& part = parts[c];
+		part.reserve((bounds[c + 1] - bounds[c]) / 8);
+		for(auto p = bounds[c]; p < bounds[c + 1];){
+			auto next = parse_next_line(p, bounds[c + 1]);
+			auto line_end = (next > p && next[-1] == '\n') ? next - 1 : next;
+			if(parse_line(p, line_end, part))
+				counts[c]++;
+			p = next;
+		}
+	}, 1);
+
+	/* Stitch the chunks together */
+	vector<size_t> offsets(chunks + 1, 0);
+	entries = 0;
+	for(size_t c = 0; c < chunks; ++c){
+		offsets[c + 1] = offsets[c] + parts[c].size();
+		entries += counts[c];
+	}
+
+	vector<EdgeRecord<IdType, WeightType>> records(offsets[chunks]);
+	parallel_for(0, chunks, [&](size_t c){
+		copy(parts[c].begin(), parts[c].end(), records.begin() + offsets[c]);
+		vector<EdgeRecord<IdType, WeightType>>().swap(parts[c]);
+	}, 1);
+
+	return records;
+}
+
+
+/*                              READERS                                   */
+
+/*! Reads a SNAP edge list: one "src dst" pair per line, separated by blanks, with an optional
+third column for the weight (1 when missing). Lines starting with '#' are comments. The nodes
+are all the ids that appear in an edge. */
+template <typename I, typename W>
+requires Comparable<I> && Numeric<W> && is_integral<I>::value
+EdgeList<I, W> read_snap(const string& path){
+
+	MappedFile file(path);
+	EdgeList<I, W> list;
+
+	size_t entries;
+	list.edges = parse_lines<I, W>(file.begin(), file.end(),
+		[](const char* p, const char* end, vector<EdgeRecord<I, W>>& out){
+
+		if(parse_at_line_end(p, end) || *p == '#' || *p == '%')
+			return false;
+
+		I src = parse_id<I>(p, end);
+		I dst = parse_id<I>(p, end);
+		W w = 1;
+		if(!parse_at_line_end(p, end))
+			parse_number(p, end, w);
+		if(!parse_at_line_end(p, end)){
+			throw std::invalid_argument("malformed line in edge list");
+		}
+
+		out.push_back(EdgeRecord<I, W>{src, w, dst});
+		return true;
+	}, entries);
+
+	/* The ids are sorted per chunk in parallel, then the sorted runs are merged */
+	size_t runs = std::max((size_t) 1, std::min(list.edges.size() / 4096, (size_t) num_threads() * 4));
+	vector<size_t> run_bounds(runs + 1);
+	for(size_t r = 0; r <= runs; ++r){
+		run_bounds[r] = 2 * (r * (list.edges.size() / runs));
+	}
+	run_bounds[runs] = 2 * list.edges.size();
+
+	auto& ids = list.nodes;
+	ids.resize(2 * list.edges.size());
+	parallel_for(0, runs, [&](size_t r){
+		for(size_t i = run_bounds[r]; i < run_bounds[r + 1]; i += 2){
+			ids[i] = list.edges[i / 2].src;
+			ids[i + 1] = list.edges[i / 2].dst;
+		}
+		sort(ids.begin() + run_bounds[r], ids.begin() + run_bounds[r + 1]);
+	}, 1);
+	for(size_t width = 1; width < runs; width *= 2){
+		for(size_t r = 0; r + width < runs; r += 2 * width){
+			inplace_merge(ids.begin() + run_bounds[r], ids.begin() + run_bounds[r + width],
+				ids.begin() + run_bounds[std::min(r + 2 * width, runs)]);
+		}
+	}
+	ids.erase(unique(ids.begin(), ids.end()), ids.end());
+
+	return list;
+}
+
+/*! Reads a Matrix Market coordinate file. Entry (i, j, v) becomes the edge from node i to node j
+with weight v, pattern files give every edge weight 1. Symmetric and skew-symmetric files give
+both directions of every off-diagonal entry. The nodes are 1 to max(rows, columns). Complex
+matrices and the dense array format are not graphs and are rejected. */
+template <typename I, typename W>
+requires Comparable<I> && Numeric<W> && is_integral<I>::value
+EdgeList<I, W> read_matrix_market(const string& path){
+
+	MappedFile file(path);
+	auto p = file.begin();
+	auto end = file.end();
+
+	/* The banner: %%MatrixMarket matrix coordinate <field> <symmetry> */
+	auto line_end = parse_next_line(p, end);
+	string banner(p, line_end);
+	for(auto& c : banner){
+		c = tolower(c);
+	}
+	if(banner.compare(0, 14, "%%matrixmarket") != 0 || banner.find("coordinate") == string::npos){
+		throw std::invalid_argument("not a Matrix Market coordinate file");
+	}
+	if(banner.find("complex") != string::npos || banner.find("hermitian") != string::npos){
+		throw std::invalid_argument("complex Matrix Market files are not supported");
+	}
+	bool pattern = banner.find("pattern") != string::npos;
+	bool skew = banner.find("skew-symmetric") != string::npos;
+	bool symmetric = skew || banner.find("symmetric") != string::npos;
+	p = line_end;
+
+	/* Comments, then the size line */
+	long long rows = 0, columns = 0, non_zeros = 0;
+	while(p < end){
+		line_end = parse_next_line(p, end);
+		auto q = p;
+		p = line_end;
+		if(parse_at_line_end(q, line_end) || *q == '%')
+			continue;
+		parse_number(q, line_end, rows);
+		parse_number(q, line_end, columns);
+		parse_number(q, line_end, non_zeros);
+		break;
+	}
+
+	EdgeList<I, W> list;
+	size_t entries;
+	list.edges = parse_lines<I, W>(p, end,
+		[pattern, symmetric, skew](const char* p, const char* end, vector<EdgeRecord<I, W>>& out){
+
+		if(parse_at_line_end(p, end) || *p == '%')
+			return false;
+
+		I row = parse_id<I>(p, end);
+		I column = parse_id<I>(p, end);
+		W w = 1;
+		if(!pattern)
+			parse_number(p, end, w);
+		if(!parse_at_line_end(p, end)){
+			throw std::invalid_argument("malformed line in edge list");
+		}
+
+		out.push_back(EdgeRecord<I, W>{row, w, column});
+		if(symmetric && row != column)
+			out.push_back(EdgeRecord<I, W>{column, skew ? -w : w, row});
+		return true;
+	}, entries);
+
+	if((long long) entries != non_zeros){
+		throw std::invalid_argument("Matrix Market file does not hold the number of entries it declares");
+	}
+
+	list.nodes.resize(std::max(rows, columns));
+	for(size_t i = 0; i < list.nodes.size(); ++i){
+		list.nodes[i] = (I) (i + 1);
+	}
+
+	return list;
+}
+
+/*! Reads a DIMACS shortest path file (.gr): a "p sp <nodes> <arcs>" problem line followed by
+"a <src> <dst> <weight>" arc lines. Lines starting with 'c' are comments. The nodes are 1 to the
+declared number of nodes. */
+template <typename I, typename W>
+requires Comparable<I> && Numeric<W> && is_integral<I>::value
+EdgeList<I, W> read_dimacs(const string& path){
+
+	MappedFile file(path);
+	auto p = file.begin();
+	auto end = file.end();
+
+	/* Comments, then the problem line */
+	long long nodes = -1, arcs = 0;
+	while(p < end){
+		auto line_end = parse_next_line(p, end);
+		auto q = p;
+		p = line_end;
+		if(parse_at_line_end(q, line_end) || *q == 'c')
+			continue;
+		if(*q != 'p'){
+			throw std::invalid_argument("DIMACS file has no problem line");
+		}
+		/* Skip the p and the problem name */
+		++q;
+		parse_skip_blanks(q, line_end);
+		while(q < line_end && !isspace(*q)){
+			++q;
+		}
+		parse_number(q, line_end, nodes);
+		parse_number(q, line_end, arcs);
+		break;
+	}
+	if(nodes < 0){
+		throw std::invalid_argument("DIMACS file has no problem line");
+	}
+
+	EdgeList<I, W> list;
+	size_t entries;
+	list.edges = parse_lines<I, W>(p, end,
+		[](const char* p, const char* end, vector<EdgeRecord<I, W>>& out){
+
+		if(parse_at_line_end(p, end) || *p == 'c')
+			return false;
+		if(*p != 'a'){
+			throw std::invalid_argument("malformed line in edge list");
+		}
+		++p;
+
+		I src = parse_id<I>(p, end);
+		I dst = parse_id<I>(p, end);
+		W w;
+		parse_number(p, end, w);
+		if(!parse_at_line_end(p, end)){
+			throw std::invalid_argument("malformed line in edge list");
+		}
+
+		out.push_back(EdgeRecord<I, W>{src, w, dst});
+		return true;
+	}, entries);
+
+	if((long long) entries != arcs){
+		throw std::invalid_argument("DIMACS file does not hold the number of arcs it declares");
+	}
+
+	list.nodes.resize(nodes);
+	for(size_t i = 0; i < list.nodes.size(); ++i){
+		list.nodes[i] = (I) (i + 1);
+	}
+
+	return list;
+}
+
+
+/*                              LOADERS                                   */
+
+/*! Adds the nodes and edges of the list to the graph, through the bulk loading path. Nodes that
+are already in the graph are kept, their new Nodes carry no data. Repeated edges with the same
+weight are loaded once, an edge given with two weights or already in the graph throws. */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+void load_edge_list(shared_ptr<GraphType<I, W, D>> g, const EdgeList<I, W>& list){
+
+	vector<shared_ptr<Node<I, D>>> node_ps;
+	node_ps.reserve(list.nodes.size());
+	for(auto id : list.nodes){
+		auto node_p = create_node<I, D>(id, nullptr);
+		if(!has_node(g, node_p))
+			node_ps.push_back(node_p);
+	}
+
+	add_nodes(g, node_ps);
+	add_edges(g, list.edges);
+}
+
+/*! Loads a SNAP edge list into the graph, see read_snap */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+inline void load_snap(shared_ptr<GraphType<I, W, D>> g, const string& path){
+	load_edge_list(g, read_snap<I, W>(path));
+}
+
+/*! Loads a Matrix Market coordinate file into the graph, see read_matrix_market */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+inline void load_matrix_market(shared_ptr<GraphType<I, W, D>> g, const string& path){
+	load_edge_list(g, read_matrix_market<I, W>(path));
+}
+
+/*! Loads a DIMACS shortest path file into the graph, see read_dimacs */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+inline void load_dimacs(shared_ptr<GraphType<I, W, D>> g, const string& path){
+	load_edge_list(g, read_dimacs<I, W>(path));
+}
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <exception>
+#include <algorithm>
+
+/*! \file */
+
+/* Number of threads used by the parallel routines, 0 means one per hardware thread */
+inline unsigned& thread_count_setting(){
+	static unsigned setting = 0;
+	return setting;
+}
+
+/*! Sets the number of threads used by the parallel importers and algorithms. Pass 0 to go back
+to one thread per hardware thread */
+inline void set_num_threads(unsigned n){
+	thread_count_setting() = n;
+}
+
+/*! Returns the number of threads used by the parallel importers and algorithms */
+inline unsigned num_threads(){
+	if(thread_count_setting() != 0)
+		return thread_count_setting();
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/*! Calls fn(t) once on each of threads threads, with t from 0 to threads - 1, and returns when all
+of them are done. The calling thread runs fn(0). If fn throws, the first exception is rethrown here
+once all the threads are done. */
+template <typename Function>
+void parallel_run(unsigned threads, Function fn){
+
+	if(threads <= 1){
+		fn(0u);
+		return;
+	}
+
+	std::exception_ptr error;
+	std::mutex error_mutex;
+
+	auto worker = [&](unsigned t){
+		try{
+			fn(t);
+		}catch(...){
+			std::lock_guard<std::mutex> lock(error_mutex);
+			if(!error)
+				error = std::current_exception();
+		}
+	};
+
+	std::vector<std::thread> pool;
+	pool.reserve(threads - 1);
+	for(unsigned t = 1; t < threads; ++t){
+		pool.emplace_back(worker, t);
+	}
+	worker(0);
+	for(auto& t : pool){
+		t.join();
+	}
+
+	if(error)
+		std::rethrow_exception(error);
+}
+
+/*! Calls fn(i) for every i in [begin, end) on num_threads() threads. The threads take the indices
+in blocks of grain, as they become free, so uneven work is balanced. With grain 0 a block size is
+picked from the length of the range. If fn throws, the first exception is rethrown here once all
+the threads are done. Small ranges run on the calling thread. */
+template <typename Function>
+void parallel_for(size_t begin, size_t end, Function fn, size_t grain = 0){
+
+	if(begin >= end)
+		return;
+
+	size_t n = end - begin;
+	unsigned threads = num_threads();
+	if(grain == 0)
+		grain = std::max((size_t) 1, n / (threads * 8));
+
+	if(threads == 1 || n <= grain){
+		for(size_t i = begin; i < end; ++i){
+			fn(i);
+		}
+		return;
+	}
+
+	threads = std::min((size_t) threads, (n + grain - 1) / grain);
+
+	std::atomic<size_t> next(begin);
+	parallel_run(threads, [&](unsigned){
+		try{
+			while(true){
+				size_t first = next.fetch_add(grain);
+				if(first >= end)
+					break;
+				size_t last = std::min(first + grain, end);
+				for(size_t i = first; i < last; ++i){
+					fn(i);
+				}
+			}
+		}catch(...){
+			/* Let the other threads run out of work */
+			next = end;
+			throw;
+		}
+	});
+}
+
+
+/*! Sorts [first, last) by less on num_threads() threads: runs of the range are sorted on their own,
+then merged pairwise, the merges of a round in parallel. Not stable. */
+template <typename Iterator, typename Compare>
+void parallel_sort(Iterator first, Iterator last, Compare less){
+
+	size_t n = last - first;
+	size_t runs = std::max((size_t) 1, std::min(n / 4096, (size_t) num_threads() * 4));
+	std::vector<size_t> bounds(runs + 1);
+	for(size_t r = 0; r <= runs; ++r){
+		bounds[r] = r * (n / runs);
+	}
+	bounds[runs] = n;
+
+	parallel_for(0, runs, [&](size_t r){
+		std::sort(first + bounds[r], first + bounds[r + 1], less);
+	}, 1);
+	for(size_t width = 1; width < runs; width *= 2){
+		parallel_for(0, (runs + 2 * width - 1) / (2 * width), [&](size_t pair){
+			size_t r = pair * 2 * width;
+			if(r + width < runs)
+				std::inplace_merge(first + bounds[r], first + bounds[r + width],
+					first + bounds[std::min(r + 2 * width, runs)], less);
+		}, 1);
+	}
+}
+
+#endif
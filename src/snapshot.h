@@ -0,0 +1,710 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "gcore.h"
+#include "io.h"
+
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+
+/*! \file */
+
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_ALIGNMENT 64
+#define SNAPSHOT_SECTIONS 5
+
+/* The sections of a snapshot, in file order */
+#define SNAPSHOT_IDS 0
+#define SNAPSHOT_ORDER 1
+#define SNAPSHOT_OFFSETS 2
+#define SNAPSHOT_TARGETS 3
+#define SNAPSHOT_WEIGHTS 4
+
+/* The file layout
+
+	header		SnapshotHeader, at offset 0
+	ids		the id of every node, in dense index order, see snapshot_id_traits
+	order		int32, the dense indices sorted by id, for looking up a node by id
+	offsets		uint64, edges of node i are [offsets[i], offsets[i + 1])
+	targets		int32, the dense index of the destination of every edge
+	weights		WeightType, the weight of every edge
+
+Every section starts at a multiple of SNAPSHOT_ALIGNMENT, so the arrays can be used straight
+from the mapped pages. Numbers are stored in the byte order of the machine that wrote the file. */
+
+/*! Where a section is in the file, and the checksum of its bytes */
+struct SnapshotSection{
+	uint64_t offset;
+	uint64_t length;
+	uint64_t checksum;
+};
+
+/*! The header of a snapshot file */
+struct SnapshotHeader{
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t id_kind;
+	uint32_t id_size;
+	uint32_t weight_kind;
+	uint32_t weight_size;
+	uint64_t num_nodes;
+	uint64_t num_edges;
+	SnapshotSection sections[SNAPSHOT_SECTIONS];
+	/* Checksum of all the fields above */
+	uint64_t header_checksum;
+};
+
+/*! A fast 64 bit checksum over a block of bytes. Four independent lanes of multiply and rotate
+keep the loop close to memory bandwidth */
+inline uint64_t snapshot_checksum(const void * data, size_t length){
+
+	const uint64_t P1 = 0x9E3779B185EBCA87ull;
+	const uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+	auto rotl = [](uint64_t x, int r){ return (x << r) | (x >> (64 - r)); };
+
+	auto p = (const unsigned char*) data;
+	uint64_t lanes[4] = {P1 + P2, P2, 0, 0 - P1};
+
+	size_t i = 0;
+	for(; i + 32 <= length; i += 32){
+		for(int k = 0; k < 4; ++k){
+			uint64_t word;
+			memcpy(&word, p + i + 8 * k, 8);
+			lanes[k] = rotl(lanes[k] + word * P2, 31) * P1;
+		}
+	}
+
+	uint64_t h = length;
+	for(int k = 0; k < 4; ++k){
+		h = rotl(h ^ (rotl(lanes[k], 23) * P2), 27) * P1;
+	}
+	for(; i < length; ++i){
+		h = rotl(h ^ (p[i] * P1), 11) * P2;
+	}
+
+	h ^= h >> 33;
+	h *= P2;
+	h ^= h >> 29;
+	h *= P1;
+	h ^= h >> 32;
+	return h;
+}
+
+/*! Customization point for storing the ids of the Nodes in a snapshot. The default stores ids of
+trivially copyable types as a plain array. Specialize it for other IdTypes, see the specialization
+for string. A specialization provides
+
+	kind			a number that identifies the encoding, checked when loading
+	view_type		what reading an id from the mapped section gives, compares with IdType
+	write(ids, out)		appends the encoded ids to out
+	valid(section, length, count)	checks that a mapped section can hold count ids
+	view(section, count, i)	reads the id of dense index i
+	make(view)		turns a view into an IdType
+*/
+template <typename IdType>
+struct snapshot_id_traits{
+
+	static_assert(is_trivially_copyable<IdType>::value,
+		"specialize snapshot_id_traits for ids that are not trivially copyable");
+
+	using view_type = IdType;
+	static const uint32_t kind = 1;
+
+	static void write(const vector<IdType>& ids, vector<char>& out){
+		auto bytes = (const char*) ids.data();
+		out.insert(out.end(), bytes, bytes + ids.size() * sizeof(IdType));
+	}
+
+	static inline bool valid(const char * section, uint64_t length, uint64_t count){
+		return length == count * sizeof(IdType);
+	}
+
+	static inline view_type view(const char * section, uint64_t count, uint64_t i){
+		IdType id;
+		memcpy(&id, section + i * sizeof(IdType), sizeof(IdType));
+		return id;
+	}
+
+	static inline IdType make(const view_type& v){
+		return v;
+	}
+};
+
+/*! String ids are stored as count + 1 uint64 offsets into the characters that follow them */
+template <>
+struct snapshot_id_traits<string>{
+
+	using view_type = string_view;
+	static const uint32_t kind = 2;
+
+	static void write(const vector<string>& ids, vector<char>& out){
+		uint64_t offset = 0;
+		for(size_t i = 0; i <= ids.size(); ++i){
+			auto bytes = (const char*) &offset;
+			out.insert(out.end(), bytes, bytes + sizeof(uint64_t));
+			if(i < ids.size())
+				offset += ids[i].size();
+		}
+		for(auto& id : ids){
+			out.insert(out.end(), id.begin(), id.end());
+		}
+	}
+
+	static inline bool valid(const char * section, uint64_t length, uint64_t count){
+		if(length < (count + 1) * sizeof(uint64_t))
+			return false;
+		auto offsets = (const uint64_t*) section;
+		return offsets[count] == length - (count + 1) * sizeof(uint64_t);
+	}
+
+	static inline view_type view(const char * section, uint64_t count, uint64_t i){
+		auto offsets = (const uint64_t*) section;
+		auto chars = section + (count + 1) * sizeof(uint64_t);
+		return string_view(chars + offsets[i], offsets[i + 1] - offsets[i]);
+	}
+
+	static inline string make(const view_type& v){
+		return string(v);
+	}
+};
+
+/* Identifies the representation of a weight type, so a file is not read with the wrong one */
+template <typename WeightType>
+inline uint32_t snapshot_weight_kind(){
+	return (is_floating_point<WeightType>::value ? 2 : 0) | (is_signed<WeightType>::value ? 1 : 0);
+}
+
+/* Marks the byte order of the writer */
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+
+/************************* GraphSnapshot Class ****************************/
+/*! This class provides a read-only Graph served straight from a snapshot file. The file is memory
+mapped and the adjacency arrays are used in place, so loading is bounded by the page faults of
+the queries that are run, not by parsing. It answers the same queries as GraphCSR, with the same
+dense indices the snapshot was written with. The Nodes are only created when a query returns
+them, and carry no data: the data pointers of the written graph are not part of the file. */
+template <typename IdType, typename WeightType, typename DataType>
+requires Comparable<IdType> && Numeric<WeightType>
+class GraphSnapshot{
+
+	static_assert(sizeof(size_t) == sizeof(uint64_t), "snapshots need a 64 bit size_t");
+
+public:
+
+	using id_type = IdType;
+	using weight_type = WeightType;
+	using data_type = DataType;
+	using id_traits = snapshot_id_traits<IdType>;
+
+	/*! Iterates a row of the snapshot in place. Yields the neighbouring Node, or the
+	(Node, weight) pair when WithWeight is set */
+	template <bool WithWeight>
+	class adjacency_iterator{
+	public:
+		using value_type = typename conditional<WithWeight,
+			pair<const shared_ptr<Node<IdType, DataType>>&, WeightType>,
+			const shared_ptr<Node<IdType, DataType>>&>::type;
+
+		adjacency_iterator(const GraphSnapshot<IdType, WeightType, DataType>* graph, size_t position)
+			: graph(graph), position(position) {}
+
+		inline value_type operator*() const {
+			auto& node_p = graph->node_at(graph->targets[position]);
+			if constexpr (WithWeight){
+				return value_type(node_p, graph->weights[position]);
+			}else{
+				return node_p;
+			}
+		}
+
+		inline adjacency_iterator& operator++(){
+			++position;
+			return *this;
+		}
+
+		inline bool operator==(const adjacency_iterator& rhs) const {
+			return position == rhs.position;
+		}
+
+		inline bool operator!=(const adjacency_iterator& rhs) const {
+			return position != rhs.position;
+		}
+
+	private:
+		const GraphSnapshot<IdType, WeightType, DataType>* graph;
+		size_t position;
+	};
+
+	using neighbour_range = Range<adjacency_iterator<false>>;
+	using out_edge_range = Range<adjacency_iterator<true>>;
+
+	/*! Maps the snapshot at path. Throws if the file is not a snapshot, was written for other id or
+	weight types, or its header is damaged. The sections are checked against their checksums only
+	when verify is set, since that reads the whole file; see verify(). Without it the queries check
+	the indices and offsets they read and throw on a damaged file, but the dense arrays are handed
+	out as they are, so a file that may be damaged or comes from elsewhere must be verified before
+	they are used */
+	static inline shared_ptr<GraphSnapshot<IdType, WeightType, DataType>> create_graph(const string& path,
+		bool verify = false){
+
+		shared_ptr<GraphSnapshot<IdType, WeightType, DataType>> p =
+			make_shared<GraphSnapshot<IdType, WeightType, DataType>>(path);
+		if(verify && !p->verify())
+			throw std::invalid_argument("snapshot " + path + " is damaged");
+		return p;
+	}
+
+	/* Checks if the node is in the graph */
+	inline bool has_node(const shared_ptr<Node<IdType, DataType>> x){
+		return find_index(x->get_id()) != -1;
+	}
+
+	bool has_edge(const shared_ptr<Node<IdType, DataType>> src, const WeightType w,
+		const shared_ptr<Node<IdType, DataType>> dst){
+
+		int src_i = find_index(src->get_id());
+		int dst_i = find_index(dst->get_id());
+		if(src_i == -1 || dst_i == -1){
+			return false;
+		}
+
+		long position = edge_position(src_i, dst_i);
+		if(position == -1){
+			return false;
+		}
+
+		return weights[position] == w;
+	}
+
+	/* Returns all the outgoing edges from a given node */
+	vector<shared_ptr<Edge<IdType, WeightType, DataType>>> edges_of_node(const shared_ptr<Node<IdType, DataType>> x){
+
+		int row = checked_row(index_of(x));
+
+		vector<shared_ptr<Edge<IdType, WeightType, DataType>>> temp;
+		temp.reserve(offsets[row + 1] - offsets[row]);
+
+		for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+			temp.push_back(create_edge(node_at(row), weights[i], node_at(targets[i])));
+		}
+
+		return temp;
+	}
+
+	/* Returns a vector of all eges in the graph */
+	vector<shared_ptr<Edge<IdType, WeightType, DataType>>> get_edges(){
+
+		vector<shared_ptr<Edge<IdType, WeightType, DataType>>> temp;
+		temp.reserve(num_edges());
+
+		for(int row = 0; row < num_nodes(); ++row){
+			checked_row(row);
+			for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+				temp.push_back(create_edge(node_at(row), weights[i], node_at(targets[i])));
+			}
+		}
+
+		return temp;
+	}
+
+	/* Same as edges_of_node, as EdgeRefs to the cached Nodes instead of new Edges */
+	vector<EdgeRef<IdType, WeightType, DataType>> edge_refs_of_node(const shared_ptr<Node<IdType, DataType>> x){
+
+		int row = checked_row(index_of(x));
+
+		vector<EdgeRef<IdType, WeightType, DataType>> temp;
+		temp.reserve(offsets[row + 1] - offsets[row]);
+		for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+			temp.push_back({&node_at(row), &node_at(targets[i]), weights[i]});
+		}
+		return temp;
+	}
+
+	/* Same as get_edges, as EdgeRefs */
+	vector<EdgeRef<IdType, WeightType, DataType>> edge_refs(){
+
+		vector<EdgeRef<IdType, WeightType, DataType>> temp;
+		temp.reserve(num_edges());
+		for(int row = 0; row < num_nodes(); ++row){
+			checked_row(row);
+			for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+				temp.push_back({&node_at(row), &node_at(targets[i]), weights[i]});
+			}
+		}
+		return temp;
+	}
+
+	/* Returns an edge between two nodes in a graph, if such exists. Throws exp otherwise */
+	shared_ptr<Edge<IdType, WeightType, DataType>> get_edge(shared_ptr<Node<IdType, DataType>> src,
+		shared_ptr<Node<IdType, DataType>> dst){
+
+		int src_i = index_of(src);
+		int dst_i = index_of(dst);
+
+		long position = edge_position(src_i, dst_i);
+		if(position == -1)
+			throw std::invalid_argument("edge does not exist");
+
+		return create_edge(src, weights[position], dst);
+	}
+
+	/* Returns the nodes of the graph */
+	vector<shared_ptr<Node<IdType, DataType>>> get_nodes(){
+
+		vector<shared_ptr<Node<IdType, DataType>>> temp;
+		temp.reserve(num_nodes());
+		for(int i = 0; i < num_nodes(); ++i){
+			temp.push_back(node_at(i));
+		}
+		return temp;
+	}
+
+	/* Function return the neighbours of the node */
+	vector<shared_ptr<Node<IdType, DataType>>> neighbours(const shared_ptr<Node<IdType, DataType>> src){
+
+		int row = checked_row(index_of(src));
+
+		vector<shared_ptr<Node<IdType, DataType>>> temp;
+		temp.reserve(offsets[row + 1] - offsets[row]);
+
+		for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+			temp.push_back(node_at(targets[i]));
+		}
+
+		return temp;
+	}
+
+	/* Same as neighbours, but walks the row in place instead of copying it */
+	neighbour_range neighbours_view(const shared_ptr<Node<IdType, DataType>>& src){
+		int row = checked_row(index_of(src));
+		return neighbour_range(adjacency_iterator<false>(this, offsets[row]),
+			adjacency_iterator<false>(this, offsets[row + 1]));
+	}
+
+	/* Walks the outgoing edges of the node in place, as (dst, weight) pairs */
+	out_edge_range out_edges(const shared_ptr<Node<IdType, DataType>>& src){
+		int row = checked_row(index_of(src));
+		return out_edge_range(adjacency_iterator<true>(this, offsets[row]),
+			adjacency_iterator<true>(this, offsets[row + 1]));
+	}
+
+	/* Checks if exists a directed edge from src to dst */
+	bool adjacent(const shared_ptr<Node<IdType, DataType>> src, const shared_ptr<Node<IdType, DataType>> dst){
+		return edge_position(index_of(src), index_of(dst)) != -1;
+	}
+
+	/* DENSE ACCESS. Same as for GraphCSR, the arrays point into the mapped file. */
+
+	/*! Number of nodes in the snapshot. Dense indices run from 0 to num_nodes() - 1 */
+	inline int num_nodes() const {
+		return header->num_nodes;
+	}
+
+	/*! Number of edges in the snapshot */
+	inline size_t num_edges() const {
+		return header->num_edges;
+	}
+
+	/*! Returns the dense index of the node. Throws if the node is not in the graph */
+	inline int index_of(const shared_ptr<Node<IdType, DataType>>& x) const {
+		int i = find_index(x->get_id());
+		if(i == -1)
+			throw std::invalid_argument("node not in the graph");
+		return i;
+	}
+
+	/*! Returns the dense index of the node with the given id, or -1 if there is none. This is
+	a binary search over the order section */
+	int find_index(const IdType& id) const {
+		int first = 0;
+		int last = num_nodes();
+		while(first < last){
+			int middle = first + (last - first) / 2;
+			if(id_view(checked_index(order[middle])) < id)
+				first = middle + 1;
+			else
+				last = middle;
+		}
+		if(first < num_nodes() && id_view(checked_index(order[first])) == id)
+			return order[first];
+		return -1;
+	}
+
+	/*! Returns the id of the node with the given dense index, without creating the Node */
+	inline IdType id_at(int i) const {
+		return id_traits::make(id_view(i));
+	}
+
+	/*! Returns the node with the given dense index. The Node is created on the first call */
+	const shared_ptr<Node<IdType, DataType>>& node_at(int i) const {
+
+		checked_index(i);
+		call_once(cache_once, [this](){
+			node_cache.reset(new shared_ptr<Node<IdType, DataType>>[num_nodes()]);
+			node_ready.reset(new atomic<bool>[num_nodes()]());
+		});
+
+		if(!node_ready[i].load(memory_order_acquire)){
+			lock_guard<mutex> lock(cache_mutex);
+			if(!node_ready[i].load(memory_order_relaxed)){
+				node_cache[i] = create_node<IdType, DataType>(id_at(i), nullptr);
+				node_ready[i].store(true, memory_order_release);
+			}
+		}
+		return node_cache[i];
+	}
+
+	/*! Edges of the node with dense index i occupy [offset_array()[i], offset_array()[i + 1]) */
+	inline const size_t * offset_array() const {
+		return offsets;
+	}
+
+	/*! Dense index of the destination of every edge */
+	inline const int * target_array() const {
+		return targets;
+	}
+
+	/*! Weight of every edge */
+	inline const WeightType * weight_array() const {
+		return weights;
+	}
+
+	/*! Checks every section of the file against its checksum. This reads the whole file, so it
+	is not done on load unless asked for */
+	bool verify() const {
+		atomic<bool> intact(true);
+		parallel_for(0, SNAPSHOT_SECTIONS, [&](size_t s){
+			auto& section = header->sections[s];
+			if(snapshot_checksum(file->begin() + section.offset, section.length) != section.checksum)
+				intact = false;
+		}, 1);
+		return intact;
+	}
+
+	void print_graph(){
+		for(int row = 0; row < num_nodes(); ++row){
+			checked_row(row);
+			cout << id_at(row) << "-> ";
+			for(size_t i = offsets[row]; i < offsets[row + 1]; ++i){
+				cout << "(" << id_at(checked_index(targets[i])) <<
+				":" << weights[i] << "), ";
+			}
+			cout << endl;
+		}
+	}
+
+	/* Snapshots are only loaded through create_graph */
+	GraphSnapshot(const string& path) : file(new MappedFile(path)){
+
+		if(file->size() < sizeof(SnapshotHeader)){
+			throw std::invalid_argument(path + " is not a gcore snapshot");
+		}
+
+		header = (const SnapshotHeader*) file->begin();
+		if(memcmp(header->magic, "GCORESNP", 8) != 0){
+			throw std::invalid_argument(path + " is not a gcore snapshot");
+		}
+		if(header->header_checksum != snapshot_checksum(header, offsetof(SnapshotHeader, header_checksum))){
+			throw std::invalid_argument("snapshot " + path + " is damaged");
+		}
+		if(header->version != SNAPSHOT_VERSION || header->byte_order != SNAPSHOT_BYTE_ORDER){
+			throw std::invalid_argument("snapshot " + path + " was written by an incompatible version");
+		}
+		if(header->id_kind != id_traits::kind || header->id_size != sizeof(IdType) ||
+			header->weight_kind != snapshot_weight_kind<WeightType>() || header->weight_size != sizeof(WeightType)){
+			throw std::invalid_argument("snapshot " + path + " was written for other id or weight types");
+		}
+
+		/* The sections must lie inside the file, aligned, and hold the declared counts */
+		uint64_t n = header->num_nodes;
+		uint64_t m = header->num_edges;
+		uint64_t expected[SNAPSHOT_SECTIONS] = {0, n * sizeof(int), (n + 1) * sizeof(uint64_t),
+			m * sizeof(int), m * sizeof(WeightType)};
+		for(int s = 0; s < SNAPSHOT_SECTIONS; ++s){
+			auto& section = header->sections[s];
+			if(section.offset % SNAPSHOT_ALIGNMENT != 0 || section.offset > file->size() ||
+				section.length > file->size() - section.offset ||
+				(s != SNAPSHOT_IDS && section.length != expected[s])){
+				throw std::invalid_argument("snapshot " + path + " is damaged");
+			}
+		}
+
+		ids = file->begin() + header->sections[SNAPSHOT_IDS].offset;
+		order = (const int*) (file->begin() + header->sections[SNAPSHOT_ORDER].offset);
+		offsets = (const size_t*) (file->begin() + header->sections[SNAPSHOT_OFFSETS].offset);
+		targets = (const int*) (file->begin() + header->sections[SNAPSHOT_TARGETS].offset);
+		weights = (const WeightType*) (file->begin() + header->sections[SNAPSHOT_WEIGHTS].offset);
+
+		if(!id_traits::valid(ids, header->sections[SNAPSHOT_IDS].length, n) || offsets[0] != 0 || offsets[n] != m){
+			throw std::invalid_argument("snapshot " + path + " is damaged");
+		}
+	}
+
+private:
+
+	unique_ptr<MappedFile> file;
+	const SnapshotHeader * header;
+
+	/* The sections, pointing into the mapping */
+	const char * ids;
+	const int * order;
+	const size_t * offsets;
+	const int * targets;
+	const WeightType * weights;
+
+	/* Nodes created so far, by dense index. Allocated on first use, so that users of the
+	dense arrays never pay for it */
+	mutable once_flag cache_once;
+	mutable unique_ptr<shared_ptr<Node<IdType, DataType>>[]> node_cache;
+	mutable unique_ptr<atomic<bool>[]> node_ready;
+	mutable mutex cache_mutex;
+
+	/* Returns i if it is a dense index of the snapshot, throws otherwise. Guards the reads of
+	indices that come from the file */
+	inline int checked_index(int i) const {
+		if(i < 0 || i >= num_nodes())
+			throw std::invalid_argument("snapshot is damaged");
+		return i;
+	}
+
+	/* Returns row after checking that its offsets stay inside targets, throws otherwise */
+	inline int checked_row(int row) const {
+		if(offsets[row] > offsets[row + 1] || offsets[row + 1] > num_edges())
+			throw std::invalid_argument("snapshot is damaged");
+		return row;
+	}
+
+	inline typename id_traits::view_type id_view(int i) const {
+		return id_traits::view(ids, header->num_nodes, i);
+	}
+
+	/* Binary search for dst in the sorted row of src. Returns the position
+	of the edge in targets, or -1 if the nodes are not adjacent */
+	inline long edge_position(int src_i, int dst_i) const {
+		checked_row(src_i);
+		auto first = targets + offsets[src_i];
+		auto last = targets + offsets[src_i + 1];
+		auto it = lower_bound(first, last, dst_i);
+		if(it == last || *it != dst_i)
+			return -1;
+		return it - targets;
+	}
+};
+
+/*! Algorithms that build a graph from a GraphSnapshot build it as a GraphAL */
+template <>
+struct result_graph<GraphSnapshot>{
+	template <typename I, typename W, typename D>
+	using type = GraphAL<I, W, D>;
+};
+
+
+/*                         WRITING AND LOADING                            */
+
+/*! Writes the snapshot to path. The file is written next to path and renamed over it when
+complete, so a reader never maps a half written snapshot */
+template <typename I, typename W, typename D>
+requires Comparable<I> && Numeric<W>
+void save_snapshot(const shared_ptr<GraphCSR<I, W, D>> csr, const string& path){
+
+	uint64_t n = csr->num_nodes();
+	uint64_t m = csr->num_edges();
+
+	/* Encode the ids, and sort the dense indices by id for the lookups */
+	vector<I> id_list;
+	id_list.reserve(n);
+	for(uint64_t i = 0; i < n; ++i){
+		id_list.push_back(csr->node_at(i)->get_id());
+	}
+	vector<char> id_bytes;
+	snapshot_id_traits<I>::write(id_list, id_bytes);
+
+	vector<int> order(n);
+	iota(order.begin(), order.end(), 0);
+	sort(order.begin(), order.end(), [&id_list](int a, int b){ return id_list[a] < id_list[b]; });
+
+	const char * data[SNAPSHOT_SECTIONS] = {id_bytes.data(), (const char*) order.data(),
+		(const char*) csr->offset_array(), (const char*) csr->target_array(), (const char*) csr->weight_array()};
+	uint64_t lengths[SNAPSHOT_SECTIONS] = {id_bytes.size(), n * sizeof(int), (n + 1) * sizeof(uint64_t),
+		m * sizeof(int), m * sizeof(W)};
+
+	/* Lay the sections out and fill the header */
+	SnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "GCORESNP", 8);
+	header.version = SNAPSHOT_VERSION;
+	header.byte_order = SNAPSHOT_BYTE_ORDER;
+	header.id_kind = snapshot_id_traits<I>::kind;
+	header.id_size = sizeof(I);
+	header.weight_kind = snapshot_weight_kind<W>();
+	header.weight_size = sizeof(W);
+	header.num_nodes = n;
+	header.num_edges = m;
+
+	uint64_t position = sizeof(SnapshotHeader);
+	for(int s = 0; s < SNAPSHOT_SECTIONS; ++s){
+		position = (position + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+		header.sections[s].offset = position;
+		header.sections[s].length = lengths[s];
+		position += lengths[s];
+	}
+	parallel_for(0, SNAPSHOT_SECTIONS, [&](size_t s){
+		header.sections[s].checksum = snapshot_checksum(data[s], lengths[s]);
+	}, 1);
+	header.header_checksum = snapshot_checksum(&header, offsetof(SnapshotHeader, header_checksum));
+
+	/* Write it out */
+	string temp_path = path + ".tmp";
+	{
+		ofstream out(temp_path, ios::binary | ios::trunc);
+		if(!out){
+			throw std::invalid_argument("cannot write " + path);
+		}
+
+		const char padding[SNAPSHOT_ALIGNMENT] = {0};
+		out.write((const char*) &header, sizeof(header));
+		uint64_t written = sizeof(header);
+		for(int s = 0; s < SNAPSHOT_SECTIONS; ++s){
+			out.write(padding, header.sections[s].offset - written);
+			out.write(data[s], lengths[s]);
+			written = header.sections[s].offset + lengths[s];
+		}
+
+		out.flush();
+		if(!out){
+			::remove(temp_path.c_str());
+			throw std::invalid_argument("cannot write " + path);
+		}
+	}
+
+	if(::rename(temp_path.c_str(), path.c_str()) != 0){
+		::remove(temp_path.c_str());
+		throw std::invalid_argument("cannot write " + path);
+	}
+}
+
+/*! Writes a snapshot of the graph to path, see save_snapshot for GraphCSR. The dense indices of
+the snapshot are the ones freeze_graph gives */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+requires Comparable<I> && Numeric<W> && IsGraph<I, W, D, GraphType>
+inline void save_snapshot(const GraphSP<I, W, D, GraphType> g, const string& path){
+	save_snapshot(freeze_graph(g), path);
+}
+
+/*! Maps a snapshot written by save_snapshot, see GraphSnapshot::create_graph */
+template <typename I, typename W, typename D>
+requires Comparable<I> && Numeric<W>
+inline shared_ptr<GraphSnapshot<I, W, D>> load_snapshot(const string& path, bool verify = false){
+	return GraphSnapshot<I, W, D>::create_graph(path, verify);
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "gcore.h"
 #include <algorithm>
+#include <functional>
 using namespace std;
 
 /*! \file */
@@ -0,0 +1,34 @@
+#ifndef VIEWS_H
+#define VIEWS_H
+
+/*! \file */
+
+/*! A pair of iterators over storage owned by a graph. Ranges are what the view functions
+(neighbours_view, out_edges) return: they can be walked with a range based for loop and do not
+copy or allocate anything. A range is invalidated by any change to the graph it came from. */
+template <typename Iterator>
+class Range{
+public:
+
+	using iterator = Iterator;
+
+	Range(Iterator first, Iterator last) : first(first), last(last) {}
+
+	inline Iterator begin() const {
+		return first;
+	}
+
+	inline Iterator end() const {
+		return last;
+	}
+
+	inline bool empty() const {
+		return first == last;
+	}
+
+private:
+	Iterator first;
+	Iterator last;
+};
+
+#endif
@@ -0,0 +1,128 @@
+#include <string>
+#include <limits>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+#include <stdexcept>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+template <typename Function>
+bool throws(Function fn){
+	try{
+		fn();
+	}catch(const std::invalid_argument& e){
+		return true;
+	}
+	return false;
+}
+
+/* Textbook Floyd-Warshall on a matrix of n by n, INF for no edge */
+void naive(vector<long>& d, int n, long INF){
+	for(int k = 0; k < n; ++k)
+		for(int i = 0; i < n; ++i)
+			for(int j = 0; j < n; ++j)
+				if(d[i * n + k] < INF && d[k * n + j] < INF && d[i * n + k] + d[k * n + j] < d[i * n + j])
+					d[i * n + j] = d[i * n + k] + d[k * n + j];
+}
+
+
+int main(){
+
+	set_num_threads(4);
+
+	/* A random graph over three tiles, with negative weights made from potentials so there is no
+	negative cycle: w(u, v) = c + p(u) - p(v) with c >= 0. The last nodes are never reached */
+	int n = 300;
+	long INF = numeric_limits<long>::max();
+	auto g = create_graph<int, long, int, GraphAL>();
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < n; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+
+	srand(5);
+	vector<long> potential(n);
+	for(int i = 0; i < n; i++){
+		potential[i] = rand() % 50;
+	}
+	vector<long> expected(n * n, INF);
+	vector<EdgeRecord<int, long>> records;
+	for(int i = 0; i < n - 10; i++){
+		for(int k = 0; k < 4; k++){
+			int j = rand() % (n - 10);
+			if(j == i || expected[i * n + j] != INF) continue;
+			long w = rand() % 30 + potential[i] - potential[j];
+			if(w == 0) w = 1;
+			if(w < 0 && rand() % 2) w = rand() % 30 + 1;
+			records.push_back({i, w, j});
+			expected[i * n + j] = w;
+		}
+	}
+	add_edges(g, records);
+	for(int i = 0; i < n; i++){
+		expected[i * n + i] = 0;
+	}
+	naive(expected, n, INF);
+
+	auto apsp = all_pairs_shortest_paths(g, true);
+	assert(apsp.size() == n);
+	for(int i = 0; i < n; i++){
+		for(int j = 0; j < n; j++){
+			int a = apsp.index_of(nodes[i]);
+			int b = apsp.index_of(nodes[j]);
+			assert(apsp.distance(a, b) == expected[i * n + j]);
+			assert(apsp.reachable(a, b) == (expected[i * n + j] != INF));
+
+			/* The path goes over edges and its weights add up to the distance */
+			auto path = apsp.path(nodes[i], nodes[j]);
+			if(expected[i * n + j] == INF){
+				assert(path.empty());
+				continue;
+			}
+			assert(path.front() == nodes[i] && path.back() == nodes[j]);
+			long total = 0;
+			for(size_t h = 0; h + 1 < path.size(); h++){
+				total += get_edge(g, path[h], path[h + 1])->get_weight();
+			}
+			assert(total == expected[i * n + j]);
+		}
+	}
+
+	/* Without next hops only the distances are kept */
+	auto plain = all_pairs_shortest_paths(g);
+	assert(plain.distances == apsp.distances);
+	assert(plain.next_hops.empty());
+	try{
+		plain.next_hop(0, 1);
+		assert(false);
+	}catch(const std::logic_error& e){}
+
+	/* The same graph in a GraphAM, whose matrix is copied, with removed nodes leaving holes */
+	auto m = create_graph<int, long, int, GraphAM>();
+	auto extra = create_node<int, int>(-1, nullptr);
+	add_node(m, extra);
+	add_nodes(m, nodes);
+	add_edges(m, records);
+	remove_node(m, extra);
+	auto matrix = all_pairs_shortest_paths(m);
+	assert(matrix.size() == n);
+	for(int i = 0; i < n; i++){
+		for(int j = 0; j < n; j++){
+			assert(matrix.distance(nodes[i], nodes[j]) == expected[i * n + j]);
+		}
+	}
+	assert(throws([&](){ matrix.index_of(extra); }));
+
+	/* A negative cycle */
+	auto c = create_graph<int, int, int, GraphAM>();
+	add_nodes(c, {nodes[0], nodes[1], nodes[2]});
+	add_edges(c, {{0, 1, 1}, {1, -3, 2}, {2, 1, 0}});
+	assert(throws([&](){ all_pairs_shortest_paths(c); }));
+
+	cout << "all_pairs: OK\n";
+	return 0;
+}
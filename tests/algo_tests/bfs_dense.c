@@ -0,0 +1,94 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+/* Checks a bfs_dense result against plain bfs depths */
+template <typename GraphType>
+void check(const GraphType& csr, int root, const DenseBFS& result){
+
+	int n = csr->num_nodes();
+	vector<int> depth(n, -1);
+	vector<int> queue{root};
+	depth[root] = 0;
+	for(size_t i = 0; i < queue.size(); ++i){
+		int u = queue[i];
+		for(size_t e = csr->offset_array()[u]; e < csr->offset_array()[u + 1]; ++e){
+			int v = csr->target_array()[e];
+			if(depth[v] == -1){
+				depth[v] = depth[u] + 1;
+				queue.push_back(v);
+			}
+		}
+	}
+
+	assert(result.parent[root] == root);
+	for(int v = 0; v < n; ++v){
+		assert(result.depth[v] == depth[v]);
+		if(v == root || depth[v] == -1) continue;
+
+		/* The parent is one level up, with an edge to v */
+		int u = result.parent[v];
+		assert(depth[u] == depth[v] - 1);
+		assert(adjacent(csr, csr->node_at(u), csr->node_at(v)));
+	}
+}
+
+
+int main(){
+
+	/* A random graph dense enough to go bottom-up, plus a tail of nodes that are reached late
+	and a few that are never reached */
+	auto g = create_graph<int, int, int, GraphAL>();
+	int n = 3000;
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < n; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+
+	srand(7);
+	vector<EdgeRecord<int, int>> records;
+	for(int i = 0; i < 2500; i++){
+		for(int k = 0; k < 8; k++){
+			int j = rand() % 2500;
+			records.push_back({i, 1 + (i + j) % 5, j});
+		}
+	}
+	for(int i = 2500; i < 2990; i++){
+		records.push_back({i - 1, 1, i});
+	}
+	add_edges(g, records);
+
+	auto plain = freeze_graph(g);
+	auto pulling = freeze_graph(g, true);
+	assert(!plain->has_in_edges() && pulling->has_in_edges());
+
+	DenseBFS result;
+	for(int root : {0, 17, 2499, 2995}){
+		bfs_dense(plain, root, result);
+		check(plain, root, result);
+		bfs_dense(pulling, root, result);
+		check(pulling, root, result);
+	}
+	assert(!result.reached(0) && result.reached(2995));
+
+	/* The tree holds the reached nodes and the edges to them from their parents */
+	auto from_node = bfs_dense(pulling, nodes[0]);
+	auto tree = bfs_tree(pulling, from_node);
+	size_t reached = 0;
+	for(int v = 0; v < n; ++v){
+		reached += from_node.reached(v);
+	}
+	assert(get_nodes(tree).size() == reached && get_edges(tree).size() == reached - 1);
+	for(auto edge : get_edges(tree)){
+		assert(has_edge(g, edge));
+	}
+
+	cout << "bfs_dense: OK\n";
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+/* Serial union-find, to check against */
+int find(vector<int>& parent, int u){
+	while(parent[u] != u){
+		u = parent[u] = parent[parent[u]];
+	}
+	return u;
+}
+
+
+int main(){
+
+	set_num_threads(4);
+
+	/* A large component, a few small ones, chains that are joined only by their direction
+	against the edges, and isolated nodes */
+	auto g = create_graph<int, int, int, GraphAL>();
+	int n = 30000;
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < n; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+
+	srand(23);
+	vector<EdgeRecord<int, int>> records;
+	for(int i = 0; i < 20000; i++){
+		for(int k = 0; k < 3; k++){
+			records.push_back({i, 1, rand() % 20000});
+		}
+	}
+	for(int i = 20000; i < 25000; i++){
+		int block = i / 100 * 100;
+		records.push_back({i, 1, block + rand() % 100});
+	}
+	for(int i = 25000; i < 28000; i++){
+		if(i % 10 != 0)
+			records.push_back({i + 1, 1, i});
+	}
+	for(int i = 28000; i < 28500; i++){
+		records.push_back({i, 1, rand() % 20000});
+	}
+	add_edges(g, records);
+
+	vector<int> parent(n);
+	for(int i = 0; i < n; i++){
+		parent[i] = i;
+	}
+	for(auto& record : records){
+		int a = find(parent, record.src);
+		int b = find(parent, record.dst);
+		parent[max(a, b)] = min(a, b);
+	}
+
+	for(bool with_in_edges : {false, true}){
+		auto csr = freeze_graph(g, with_in_edges);
+		auto comp = connected_components_dense(csr);
+		assert(comp.size() == (size_t) n);
+
+		/* Same partition, labelled by the smallest index in the component */
+		vector<int> smallest(n, -1);
+		for(int u = 0; u < n; ++u){
+			int root = find(parent, csr->node_at(u)->get_id());
+			if(smallest[root] == -1)
+				smallest[root] = u;
+			assert(comp[u] == smallest[root]);
+		}
+	}
+
+	/* The nodes grouped by component */
+	auto components = connected_components(g);
+	size_t total = 0;
+	size_t expected = 0;
+	for(int i = 0; i < n; i++){
+		expected += find(parent, i) == i;
+	}
+	assert(components.size() == expected);
+	for(auto& component : components){
+		int root = find(parent, component.front()->get_id());
+		for(auto& x : component){
+			assert(find(parent, x->get_id()) == root);
+		}
+		total += component.size();
+	}
+	assert(total == (size_t) n);
+	assert(connected_components(create_graph<int, int, int, GraphAM>()).empty());
+
+	cout << "connected_components: OK\n";
+	return 0;
+}
@@ -0,0 +1,141 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+#include <stdexcept>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+/* Counts the events, and checks that they come in a consistent order */
+template <typename V>
+struct CountingVisitor : DFSVisitor{
+	size_t starts = 0, discovered = 0, examined = 0, tree = 0, back = 0, other = 0, finished = 0;
+	vector<V> stack;
+
+	void start_vertex(const V& u){ ++starts; }
+	void discover_vertex(const V& u){ ++discovered; stack.push_back(u); }
+	template <typename W> void examine_edge(const V& u, const V& v, const W& w){
+		assert(stack.back() == u);
+		++examined;
+	}
+	template <typename W> void tree_edge(const V& u, const V& v, const W& w){ ++tree; }
+	template <typename W> void back_edge(const V& u, const V& v, const W& w){ ++back; }
+	template <typename W> void forward_or_cross_edge(const V& u, const V& v, const W& w){ ++other; }
+	void finish_vertex(const V& u){
+		assert(stack.back() == u);
+		stack.pop_back();
+		++finished;
+	}
+};
+
+template <typename A, typename B>
+bool same_counts(const A& a, const B& b){
+	return a.starts == b.starts && a.discovered == b.discovered && a.examined == b.examined &&
+		a.tree == b.tree && a.back == b.back && a.other == b.other && a.finished == b.finished;
+}
+
+
+int main(){
+
+	/* A random DAG: edges only go from lower to higher ids */
+	auto g = create_graph<int, int, int, GraphAL>();
+	int n = 5000;
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < n; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+
+	srand(3);
+	vector<EdgeRecord<int, int>> records;
+	for(int i = 0; i < n - 1; i++){
+		for(int k = 0; k < 4; k++){
+			int j = i + 1 + rand() % min(50, n - 1 - i);
+			records.push_back({i, 1, j});
+		}
+	}
+	add_edges(g, records);
+	auto csr = freeze_graph(g);
+
+	/* The engines agree, and every edge is examined once */
+	CountingVisitor<int> dense_counts;
+	CountingVisitor<NodeSP<int, int>> counts;
+	assert(depth_first_search_dense(csr, dense_counts));
+	assert(depth_first_search(g, counts));
+	assert(same_counts(dense_counts, counts));
+	assert(counts.examined == csr->num_edges() && counts.discovered == (size_t) n);
+	assert(counts.finished == (size_t) n && counts.tree == n - counts.starts);
+	assert(counts.back == 0);
+
+	auto order = topological_sort_dense(csr);
+	vector<int> position(n);
+	for(int i = 0; i < n; ++i){
+		position[order[i]] = i;
+	}
+	for(int u = 0; u < n; ++u){
+		for(size_t e = csr->offset_array()[u]; e < csr->offset_array()[u + 1]; ++e){
+			assert(position[u] < position[csr->target_array()[e]]);
+		}
+	}
+	/* The mutable graph is searched in insertion order, so its order may differ but must be valid too */
+	auto node_order = topological_sort(g);
+	assert(node_order.size() == (size_t) n);
+	for(int i = 0; i < n; ++i){
+		position[node_order[i]->get_id()] = i;
+	}
+	for(auto& record : records){
+		assert(position[record.src] < position[record.dst]);
+	}
+	assert(find_cycle_dense(csr).empty() && !has_cycle(g));
+
+	/* A back edge closes a cycle */
+	add_edge(g, nodes[4000], 1, nodes[10]);
+	auto cycle = find_cycle(g);
+	assert(!cycle.empty() && has_cycle(g));
+	for(size_t i = 0; i < cycle.size(); ++i){
+		assert(adjacent(g, cycle[i], cycle[(i + 1) % cycle.size()]));
+	}
+	bool thrown = false;
+	try{
+		topological_sort(g);
+	}catch(const std::invalid_argument& e){
+		thrown = true;
+	}
+	assert(thrown);
+
+	auto frozen = freeze_graph(g);
+	auto dense_cycle = find_cycle_dense(frozen);
+	assert(!dense_cycle.empty());
+	for(size_t i = 0; i < dense_cycle.size(); ++i){
+		assert(adjacent(frozen, frozen->node_at(dense_cycle[i]), frozen->node_at(dense_cycle[(i + 1) % dense_cycle.size()])));
+	}
+
+	/* A self loop is a cycle of one node */
+	auto loop = create_graph<int, int, int, GraphAM>();
+	add_nodes(loop, {nodes[6], nodes[7]});
+	add_edge(loop, nodes[6], 1, nodes[7]);
+	add_edge(loop, nodes[7], 1, nodes[7]);
+	auto loop_cycle = find_cycle(loop);
+	assert(loop_cycle.size() == 1 && loop_cycle[0] == nodes[7]);
+
+	/* Deep paths do not recurse */
+	auto path = create_graph<int, int, int, GraphAL>();
+	vector<NodeSP<int, int>> path_nodes;
+	vector<EdgeRecord<int, int>> path_records;
+	for(int i = 0; i < 200000; i++){
+		path_nodes.push_back(create_node<int, int>(i, nullptr));
+		if(i > 0)
+			path_records.push_back({i - 1, 1, i});
+	}
+	add_nodes(path, path_nodes);
+	add_edges(path, path_records);
+	CountingVisitor<NodeSP<int, int>> path_counts;
+	depth_first_visit(path, path_nodes[0], path_counts);
+	assert(path_counts.tree == 199999 && path_counts.finished == 200000);
+	assert(get_edges(dfs(path, path_nodes[0])).size() == 199999);
+
+	cout << "dfs_visitor: OK\n";
+	return 0;
+}
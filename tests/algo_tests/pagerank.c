@@ -0,0 +1,142 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stdexcept>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+/* Serial power iteration pushing along the out-edges, to check against */
+vector<double> reference(shared_ptr<GraphCSR<int, int, int>> csr, const vector<double>& teleport,
+	double damping, int iterations){
+
+	int n = csr->num_nodes();
+	const size_t * offsets = csr->offset_array();
+	const int * targets = csr->target_array();
+	vector<double> rank(teleport);
+	for(int k = 0; k < iterations; ++k){
+		vector<double> next(n, 0);
+		double dangling = 0;
+		for(int u = 0; u < n; ++u){
+			size_t degree = offsets[u + 1] - offsets[u];
+			if(degree == 0)
+				dangling += rank[u];
+			for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+				next[targets[e]] += damping * rank[u] / degree;
+			}
+		}
+		for(int v = 0; v < n; ++v){
+			next[v] += (1 - damping + damping * dangling) * teleport[v];
+		}
+		rank = next;
+	}
+	return rank;
+}
+
+double distance(const vector<double>& a, const vector<double>& b){
+	double d = 0;
+	for(size_t i = 0; i < a.size(); ++i){
+		d += fabs(a[i] - b[i]);
+	}
+	return d;
+}
+
+template <typename Function>
+bool throws(Function fn){
+	try{
+		fn();
+	}catch(const std::invalid_argument& e){
+		return true;
+	}
+	return false;
+}
+
+
+int main(){
+
+	set_num_threads(4);
+
+	/* Random graph with hubs and dangling nodes */
+	auto g = create_graph<int, int, int, GraphAL>();
+	int n = 20000;
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < n; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+
+	srand(31);
+	vector<EdgeRecord<int, int>> records;
+	for(int i = 0; i < 18000; i++){
+		for(int k = 0; k < 1 + i % 9; k++){
+			int j = k % 2 ? rand() % 50 : rand() % n;
+			records.push_back({i, 1, j});
+		}
+	}
+	add_edges(g, records);
+
+	auto csr = freeze_graph(g);
+	auto csr_in = freeze_graph(g, true);
+
+	auto result = pagerank_dense(csr_in, 0.85, 1e-12, 200);
+	assert(result.error < 1e-12 && result.iterations < 200);
+	double sum = 0;
+	for(auto r : result.rank){
+		sum += r;
+	}
+	assert(fabs(sum - 1) < 1e-9);
+
+	vector<double> uniform(n, 1.0 / n);
+	assert(distance(result.rank, reference(csr, uniform, 0.85, result.iterations)) < 1e-9);
+	assert(distance(pagerank_dense(csr, 0.85, 1e-12, 200).rank, result.rank) < 1e-12);
+
+	/* Same ranks on one thread */
+	set_num_threads(1);
+	assert(distance(pagerank_dense(csr_in, 0.85, 1e-12, 200).rank, result.rank) < 1e-12);
+	set_num_threads(4);
+
+	/* The iteration cap */
+	PageRank capped;
+	pagerank_dense(csr_in, capped, 0.85, 0, 3);
+	assert(capped.iterations == 3 && capped.error > 0);
+	assert(distance(capped.rank, reference(csr, uniform, 0.85, 3)) < 1e-12);
+
+	/* Personalized: the surfer comes back to node 19000, nodes it does not reach get nothing */
+	add_edge(g, nodes[19000], 1, nodes[7]);
+	auto seeded = personalized_pagerank(g, {nodes[19000]}, 0.85, 1e-12, 200);
+	csr = freeze_graph(g);
+	vector<double> teleport(n, 0);
+	teleport[csr->index_of(nodes[19000])] = 1;
+	auto expected = reference(csr, teleport, 0.85, 200);
+	auto reached = bfs_dense(csr, nodes[19000]);
+	size_t unreached = 0;
+	for(auto& entry : seeded){
+		int u = csr->index_of(entry.first);
+		assert(fabs(entry.second - expected[u]) < 1e-9);
+		if(!reached.reached(u)){
+			assert(entry.second == 0);
+			unreached++;
+		}
+	}
+	assert(unreached > 0);
+
+	/* A directed cycle ranks all its nodes the same */
+	auto cycle = create_graph<int, int, int, GraphAM>();
+	add_nodes(cycle, {nodes[0], nodes[1], nodes[2]});
+	add_edge(cycle, nodes[0], 1, nodes[1]);
+	add_edge(cycle, nodes[1], 1, nodes[2]);
+	add_edge(cycle, nodes[2], 1, nodes[0]);
+	for(auto& entry : pagerank(cycle)){
+		assert(fabs(entry.second - 1.0 / 3) < 1e-9);
+	}
+
+	assert(throws([&](){ pagerank_dense(csr, 1.0); }));
+	assert(throws([&](){ personalized_pagerank_dense(csr, vector<double>(3, 1)); }));
+	assert(throws([&](){ personalized_pagerank_dense(csr, vector<double>(n, 0)); }));
+
+	cout << "pagerank: OK\n";
+	return 0;
+}
@@ -0,0 +1,88 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+int main(){
+
+	set_num_threads(4);
+
+	/* A random graph with a long tail, and nodes that are never reached */
+	auto g = create_graph<int, int, int, GraphAL>();
+	int n = 20000;
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < n; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+
+	srand(11);
+	vector<EdgeRecord<int, int>> records;
+	for(int i = 0; i < 15000; i++){
+		for(int k = 0; k < 6; k++){
+			int j = rand() % 15000;
+			records.push_back({i, 1 + (i + j) % 3, j});
+		}
+	}
+	for(int i = 15000; i < 19000; i++){
+		records.push_back({i - 1, 1, i});
+	}
+	add_edges(g, records);
+
+	auto plain = freeze_graph(g);
+	auto pulling = freeze_graph(g, true);
+
+	DenseBFS serial, parallel;
+	for(auto csr : {plain, pulling}){
+		for(int root : {0, 42, 14999, 19500}){
+			bfs_dense(csr, root, serial);
+			parallel_bfs_dense(csr, root, parallel);
+
+			/* Depths match, parents may differ but sit one level up with an edge down */
+			assert(parallel.depth == serial.depth);
+			for(int v = 0; v < n; ++v){
+				if(!parallel.reached(v) || v == root) continue;
+				int u = parallel.parent[v];
+				assert(parallel.depth[u] == parallel.depth[v] - 1);
+				assert(adjacent(csr, csr->node_at(u), csr->node_at(v)));
+			}
+		}
+	}
+
+	/* The tree of the mutable graph version spans the same nodes */
+	auto tree = parallel_bfs(g, nodes[0]);
+	bfs_dense(pulling, 0, serial);
+	size_t reached = 0;
+	for(int v = 0; v < n; ++v){
+		reached += serial.reached(v);
+	}
+	assert(get_nodes(tree).size() == reached && get_edges(tree).size() == reached - 1);
+
+	/* Reachability from several roots is the union of what they reach */
+	auto marks = reachable_from_dense(plain, {5, 19500, 19999});
+	bfs_dense(plain, 5, serial);
+	for(int v = 0; v < n; ++v){
+		assert((bool) marks[v] == (serial.reached(v) || v == 19500 || v == 19999));
+	}
+	assert(reachable_from_dense(plain, {}) == vector<char>(n, 0));
+
+	auto from_nodes = reachable_from(g, vector<NodeSP<int, int>>{nodes[14999]});
+	bfs_dense(plain, 14999, serial);
+	reached = 0;
+	for(int v = 0; v < n; ++v){
+		reached += serial.reached(v);
+	}
+	assert(from_nodes.size() == reached);
+
+	/* One thread gives the same answers */
+	set_num_threads(1);
+	parallel_bfs_dense(pulling, 14999, parallel);
+	assert(parallel.depth == serial.depth);
+
+	cout << "parallel_bfs: OK\n";
+	return 0;
+}
@@ -0,0 +1,112 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+shared_ptr<GraphAL<int, int, int>> build(int n, const vector<EdgeRecord<int, int>>& records){
+	auto g = create_graph<int, int, int, GraphAL>();
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < n; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+	add_edges(g, records);
+	return g;
+}
+
+/* Both algorithms, with and without in-edges, give the same labels */
+vector<int> check_agree(const shared_ptr<GraphAL<int, int, int>>& g){
+	auto csr = freeze_graph(g);
+	auto labels = strongly_connected_components_dense(csr);
+	assert(parallel_strongly_connected_components_dense(csr) == labels);
+	auto csr_in = freeze_graph(g, true);
+	assert(strongly_connected_components_dense(csr_in) == labels);
+	assert(parallel_strongly_connected_components_dense(csr_in) == labels);
+	return labels;
+}
+
+
+int main(){
+
+	set_num_threads(4);
+	srand(29);
+
+	/* Small random graph against pairwise reachability */
+	int n = 800;
+	vector<EdgeRecord<int, int>> records;
+	for(int i = 0; i < 1400; i++){
+		records.push_back({rand() % n, 1, rand() % n});
+	}
+	auto small = build(n, records);
+	auto labels = check_agree(small);
+	auto csr = freeze_graph(small);
+	vector<DenseBFS> reach(n);
+	for(int u = 0; u < n; ++u){
+		bfs_dense(csr, u, reach[u]);
+	}
+	for(int u = 0; u < n; ++u){
+		for(int v = 0; v < n; ++v){
+			bool together = reach[u].reached(v) && reach[v].reached(u);
+			assert((labels[u] == labels[v]) == together);
+		}
+		assert(labels[u] <= u && labels[labels[u]] == labels[u]);
+	}
+
+	/* Larger graph: a giant component, cycles of many sizes, and a DAG hanging off them */
+	n = 60000;
+	records.clear();
+	for(int i = 0; i < 20000; i++){
+		records.push_back({i, 1, (i + 1) % 20000});
+		records.push_back({i, 1, rand() % 20000});
+	}
+	for(int i = 20000; i < 40000; i++){
+		int size = 1 + i % 17;
+		int block = i / size * size;
+		records.push_back({i, 1, block + (i - block + 1) % size});
+	}
+	for(int i = 40000; i < n; i++){
+		records.push_back({i, 1, rand() % i});
+		records.push_back({rand() % i, 1, i});
+	}
+	auto large = build(n, records);
+	check_agree(large);
+	auto components = strongly_connected_components(large);
+	size_t total = 0;
+	for(auto& component : components){
+		total += component.size();
+	}
+	assert(total == (size_t) n);
+
+	/* Deep graphs: one long cycle, long chains both ways, and a chain of 2-cycles that trimming
+	cannot take apart */
+	n = 100000;
+	for(int kind = 0; kind < 4; ++kind){
+		records.clear();
+		for(int i = 0; i + 1 < n; i++){
+			if(kind == 3)
+				records.push_back({i + 1, 1, i & ~1});
+			else if(kind == 2)
+				records.push_back({i + 1, 1, i});
+			else
+				records.push_back({i, 1, i + 1});
+		}
+		if(kind == 0)
+			records.push_back({n - 1, 1, 0});
+		if(kind == 3){
+			for(int i = 0; i < n; i += 2){
+				records.push_back({i, 1, i + 1});
+			}
+		}
+		labels = check_agree(build(n, records));
+		for(int u = 0; u < n; ++u){
+			assert(labels[u] == (kind == 0 ? 0 : kind == 3 ? u & ~1 : u));
+		}
+	}
+
+	cout << "scc: OK\n";
+	return 0;
+}
@@ -0,0 +1,164 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+#include <stdexcept>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+int main(){
+
+	set_num_threads(4);
+
+	/* A random graph with weights from 0 to 20, a long tail, and nodes that are never reached */
+	auto g = create_graph<int, long, int, GraphAL>();
+	int n = 20000;
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < n; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+
+	srand(17);
+	vector<EdgeRecord<int, long>> records;
+	for(int i = 0; i < 15000; i++){
+		for(int k = 0; k < 5; k++){
+			int j = rand() % 15000;
+			records.push_back({i, (long) ((i * 7 + j) % 21), j});
+		}
+	}
+	for(int i = 15000; i < 19000; i++){
+		records.push_back({i - 1, 3, i});
+	}
+	add_edges(g, records);
+
+	auto csr = freeze_graph(g);
+	const size_t * offsets = csr->offset_array();
+	const int * targets = csr->target_array();
+	const long * weights = csr->weight_array();
+
+	ShortestPaths<long> serial, parallel;
+	for(int source : {0, 42, 18000, 19500}){
+		dijkstra_dense(csr, source, serial);
+		for(long delta : {0L, 1L, 50L}){
+			delta_stepping_dense(csr, source, parallel, delta);
+			assert(parallel.distance == serial.distance);
+
+			/* Every parent sits on a shortest path */
+			for(int v = 0; v < n; ++v){
+				assert(parallel.reached(v) == serial.reached(v));
+				if(!parallel.reached(v) || v == source) continue;
+				int u = parallel.parent[v];
+				bool tight = false;
+				for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+					tight |= targets[e] == v && parallel.distance[u] + weights[e] == parallel.distance[v];
+				}
+				assert(tight);
+			}
+		}
+
+		/* No edge is left that shortens a distance */
+		for(int u = 0; u < n; ++u){
+			if(!serial.reached(u)) continue;
+			for(size_t e = offsets[u]; e < offsets[u + 1]; ++e){
+				assert(serial.distance[targets[e]] <= serial.distance[u] + weights[e]);
+			}
+		}
+	}
+
+	/* A small delta on a graph with large distances keeps a few buckets only, and so does a delta
+	far below the weights */
+	auto far = create_graph<int, long, int, GraphAL>();
+	vector<NodeSP<int, int>> far_nodes;
+	vector<EdgeRecord<int, long>> far_records;
+	for(int i = 0; i < 2000; i++){
+		far_nodes.push_back(create_node<int, int>(i, nullptr));
+		if(i > 0)
+			far_records.push_back({i - 1, 1000000000L + i, i});
+		if(i > 2)
+			far_records.push_back({i / 2, 3000000000L, i});
+	}
+	add_nodes(far, far_nodes);
+	add_edges(far, far_records);
+	auto far_csr = freeze_graph(far);
+	dijkstra_dense(far_csr, 0, serial);
+	for(long delta : {1L, 1000L, 1000000000L}){
+		delta_stepping_dense(far_csr, 0, parallel, delta);
+		assert(parallel.distance == serial.distance);
+	}
+
+	/* Stopping at the target keeps its distance and path */
+	dijkstra_dense(csr, 0, serial);
+	auto early = dijkstra_dense(csr, 0, 18500);
+	assert(early.distance[18500] == serial.distance[18500]);
+	auto path = early.path_to(18500);
+	assert(path.front() == 0 && path.back() == 18500);
+	long length = 0;
+	for(size_t i = 1; i < path.size(); ++i){
+		length += get_edge(csr, csr->node_at(path[i - 1]), csr->node_at(path[i]))->get_weight();
+	}
+	assert(length == serial.distance[18500]);
+
+	/* A ShortestPaths left by an early stop on a small graph serves a full run on a larger one */
+	auto small = create_graph<int, long, int, GraphAL>();
+	add_nodes(small, {nodes[0], nodes[1], nodes[2]});
+	add_edges(small, vector<EdgeRecord<int, long>>{{0, 1, 1}, {1, 1, 2}, {0, 5, 2}});
+	ShortestPaths<long> reused;
+	dijkstra_dense(freeze_graph(small), 0, reused, 1);
+	dijkstra_dense(csr, 0, reused);
+	assert(reused.distance == serial.distance);
+	dijkstra_dense(freeze_graph(small), 0, reused);
+	assert(reused.distance == vector<long>({0, 1, 2}));
+
+	long distance;
+	auto nodes_path = shortest_path(csr, nodes[0], nodes[18500], distance);
+	assert(distance == serial.distance[18500] && nodes_path.size() == path.size());
+	assert(shortest_path(csr, nodes[0], nodes[19500], distance).empty());
+
+	/* A stream of queries through one ShortestPaths answers like fresh ones */
+	ShortestPaths<long> queries;
+	for(int i = 0; i < 20; ++i){
+		auto& from = nodes[(i * 131) % 15000];
+		auto& to = nodes[(i * 977) % 19000];
+		long fresh_distance, reused_distance;
+		auto fresh = shortest_path(csr, from, to, fresh_distance);
+		auto reused_path = shortest_path(csr, from, to, reused_distance, queries);
+		assert(reused_path.size() == fresh.size());
+		if(!fresh.empty())
+			assert(reused_distance == fresh_distance);
+	}
+
+	/* The tree of the mutable graph version spans the reached nodes */
+	auto tree = dijkstra(g, nodes[0]);
+	size_t reached = 0;
+	for(int v = 0; v < n; ++v){
+		reached += serial.reached(v);
+	}
+	assert(get_nodes(tree).size() == reached);
+	assert(get_edges(tree).size() == reached - 1);
+
+	/* Negative weights are refused */
+	auto negative = create_graph<int, int, int, GraphAL>();
+	add_nodes(negative, {create_node<int, int>(1, nullptr), create_node<int, int>(2, nullptr)});
+	add_edges(negative, vector<EdgeRecord<int, int>>{{1, -4, 2}});
+	auto frozen = freeze_graph(negative);
+	bool thrown = false;
+	try{
+		dijkstra_dense(frozen, 0);
+	}catch(const std::invalid_argument& e){
+		thrown = true;
+	}
+	assert(thrown);
+	thrown = false;
+	try{
+		delta_stepping_dense(frozen, 0);
+	}catch(const std::invalid_argument& e){
+		thrown = true;
+	}
+	assert(thrown);
+
+	cout << "shortest_paths: OK\n";
+	return 0;
+}
@@ -0,0 +1,112 @@
+#include <set>
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+#include <stdexcept>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+/* Kruskal on (weight, src, dst) triples with a plain union-find, for the weight of the forest */
+long reference_weight(vector<EdgeRecord<int, long>> records, int n){
+	sort(records.begin(), records.end(), [](const EdgeRecord<int, long>& a, const EdgeRecord<int, long>& b){
+		return a.weight < b.weight;
+	});
+	vector<int> parent(n);
+	for(int i = 0; i < n; i++) parent[i] = i;
+	std::function<int(int)> find = [&](int u){ return parent[u] == u ? u : parent[u] = find(parent[u]); };
+	long total = 0;
+	for(auto& r : records){
+		int a = find(r.src), b = find(r.dst);
+		if(a == b) continue;
+		parent[a] = b;
+		total += r.weight;
+	}
+	return total;
+}
+
+
+int main(){
+
+	set_num_threads(4);
+
+	/* parallel_sort over many runs */
+	vector<int> values(100000);
+	srand(3);
+	for(auto& v : values) v = rand() % 1000;
+	auto sorted = values;
+	sort(sorted.begin(), sorted.end());
+	parallel_sort(values.begin(), values.end(), [](int a, int b){ return a < b; });
+	assert(values == sorted);
+
+	/* A random graph with few distinct weights, so there are many ties, self loops, edges in both
+	directions, and components: nodes 18000 and up are only joined among themselves */
+	int n = 20000;
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < n; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	vector<EdgeRecord<int, long>> records;
+	set<pair<int, int>> pairs;
+	for(int i = 0; i < 18000; i++){
+		for(int k = 0; k < 3; k++){
+			int j = rand() % 18000;
+			if(pairs.insert({i, j}).second)
+				records.push_back({i, (long) (rand() % 10 - 3), j});
+		}
+	}
+	for(int i = 18000; i < n - 50; i++){
+		records.push_back({i + 1 + rand() % 40, (long) (rand() % 5), i});
+	}
+	records.push_back({7, 1, 7});
+
+	auto g = create_graph<int, long, int, GraphAL>();
+	add_nodes(g, nodes);
+	add_edges(g, records);
+	auto csr = freeze_graph(g);
+
+	auto kruskal = kruskal_dense(csr);
+	auto boruvka = boruvka_dense(csr);
+	assert(kruskal.edges == boruvka.edges);
+	assert(kruskal.weight == boruvka.weight && kruskal.trees == boruvka.trees);
+
+	/* Every tree is a weakly connected component */
+	auto labels = connected_components_dense(csr);
+	int components = 0;
+	for(int u = 0; u < n; u++){
+		components += labels[u] == u;
+	}
+	assert(kruskal.trees == components);
+	assert((int) kruskal.edges.size() == n - components);
+
+	assert(boruvka.weight == reference_weight(records, n));
+
+	/* Reusing the result, with one thread */
+	set_num_threads(1);
+	boruvka_dense(csr, boruvka);
+	assert(boruvka.edges == kruskal.edges);
+	set_num_threads(4);
+
+	/* As graphs, in the type of the input */
+	auto forest = minimum_spanning_forest(g);
+	assert(get_nodes(forest).size() == (size_t) n);
+	long total = 0;
+	for(auto edge : get_edges(forest)){
+		assert(has_edge(g, edge));
+		total += edge->get_weight();
+	}
+	assert(total == kruskal.weight);
+	assert(get_edges(spanning_forest_graph(csr, kruskal)).size() == kruskal.edges.size());
+
+	auto m = create_graph<int, long, int, GraphAM>();
+	add_nodes(m, {nodes[0], nodes[1], nodes[2], nodes[3]});
+	add_edges(m, {{0, 5, 1}, {1, 2, 2}, {2, 1, 0}, {0, 9, 2}});
+	auto m_forest = minimum_spanning_forest(m);
+	assert(get_edges(m_forest).size() == 2);
+	assert(has_edge(m_forest, nodes[1], 2L, nodes[2]) && has_edge(m_forest, nodes[2], 1L, nodes[0]));
+
+	cout << "spanning_forest: OK\n";
+	return 0;
+}
@@ -0,0 +1,101 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+#include <stdexcept>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+void check(const GraphSP<I, W, D, GraphType>& g, const vector<NodeSP<I, D>>& nodes){
+	auto closure = transitive_closure(g);
+	auto csr = freeze_graph(g);
+	int n = nodes.size();
+	assert(closure.size() == n);
+
+	/* bfs from every node gives the reachability, and the cycles through the out edges */
+	vector<vector<bool>> reach(n, vector<bool>(n));
+	for(int i = 0; i < n; i++){
+		auto tree = bfs_dense(csr, nodes[i]);
+		for(int j = 0; j < n; j++){
+			reach[i][j] = tree.reached(csr->index_of(nodes[j]));
+		}
+	}
+	for(int i = 0; i < n; i++){
+		bool cycle = false;
+		size_t count = 0;
+		for(auto x : neighbours(g, nodes[i])){
+			cycle |= reach[closure.index_of(x)][i];
+		}
+		for(int j = 0; j < n; j++){
+			assert(closure.reachable(nodes[i], nodes[j]) == reach[i][j]);
+			count += reach[i][j] && (i != j || cycle);
+		}
+		int u = closure.index_of(nodes[i]);
+		assert(closure.on_cycle(u) == cycle);
+		assert(closure.reachable_count(u) == count);
+	}
+}
+
+
+int main(){
+
+	set_num_threads(4);
+
+	/* Sparse random edges over a size that does not fill the last word, with a chain that runs
+	across the words against the order of the dense indices */
+	int n = 700;
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < n; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	srand(11);
+	vector<EdgeRecord<int, int>> records;
+	for(int i = 0; i < 600; i++){
+		if(rand() % 3 == 0)
+			records.push_back({i, 1 + rand() % 9, rand() % n});
+	}
+	for(int i = n - 1; i > 620; i--){
+		records.push_back({i, 2, i - 1});
+	}
+	records.push_back({620, 4, 690});
+	records.push_back({5, 1, 5});
+
+	auto g = create_graph<int, int, int, GraphAL>();
+	add_nodes(g, nodes);
+	add_edges(g, records);
+	check(g, nodes);
+
+	/* A GraphAM, copied from its matrix, with a hole left by a removed node */
+	auto m = create_graph<int, int, int, GraphAM>();
+	auto extra = create_node<int, int>(-1, nullptr);
+	add_node(m, extra);
+	add_nodes(m, nodes);
+	add_edges(m, records);
+	remove_node(m, extra);
+	check(m, nodes);
+	bool refused = false;
+	try{
+		transitive_closure(m).index_of(extra);
+	}catch(const std::invalid_argument& e){
+		refused = true;
+	}
+	assert(refused);
+
+	/* An unweighted GraphAM goes through its edges */
+	auto u = create_graph<int, bool, int, GraphAM>();
+	add_nodes(u, nodes);
+	for(auto& record : records){
+		add_edge(u, nodes[record.src], true, nodes[record.dst]);
+	}
+	check(u, nodes);
+
+	/* No nodes */
+	auto empty = create_graph<int, int, int, GraphAL>();
+	assert(transitive_closure(empty).size() == 0);
+
+	cout << "transitive_closure: OK\n";
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+int main(){
+
+	set_num_threads(4);
+	srand(37);
+
+	/* The vectorized intersection against the standard one */
+	for(int round = 0; round < 200; round++){
+		vector<int> a, b, expected, found;
+		for(int x = 0; x < 400; x++){
+			if(rand() % 3 == 0) a.push_back(x);
+			if(rand() % (1 + round % 5) == 0) b.push_back(x);
+		}
+		set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expected));
+		intersect_sorted(a.data(), a.size(), b.data(), b.size(), [&](int x){ found.push_back(x); });
+		sort(found.begin(), found.end());
+		assert(found == expected);
+	}
+
+	/* Random graph with edges both ways, self loops and a hub, against brute force */
+	int n = 300;
+	auto g = create_graph<int, int, int, GraphAL>();
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < n; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+
+	vector<vector<bool>> adjacent(n, vector<bool>(n, false));
+	vector<EdgeRecord<int, int>> records;
+	for(int i = 0; i < 3000; i++){
+		int u = rand() % n;
+		int v = i % 4 == 0 ? 0 : rand() % n;
+		if(!has_edge(g, nodes[u], 1, nodes[v]) && !(u == v && i % 2)){
+			add_edge(g, nodes[u], 1, nodes[v]);
+			adjacent[u][v] = adjacent[v][u] = u != v;
+		}
+	}
+
+	size_t expected_total = 0;
+	vector<size_t> expected_nodes(n, 0);
+	vector<int> degree(n, 0);
+	for(int u = 0; u < n; u++){
+		for(int v = 0; v < n; v++){
+			degree[u] += adjacent[u][v];
+			for(int w = v + 1; w < n && v > u; w++){
+				if(adjacent[u][v] && adjacent[v][w] && adjacent[u][w]){
+					expected_total++;
+					expected_nodes[u]++;
+					expected_nodes[v]++;
+					expected_nodes[w]++;
+				}
+			}
+		}
+	}
+	assert(expected_total > 0);
+
+	for(bool with_in_edges : {false, true}){
+		auto csr = freeze_graph(g, with_in_edges);
+		assert(count_triangles_dense(csr) == expected_total);
+		auto per_node = node_triangles_dense(csr);
+		auto coefficients = clustering_coefficients_dense(csr);
+		for(int u = 0; u < n; u++){
+			int id = csr->node_at(u)->get_id();
+			assert(per_node[u] == expected_nodes[id]);
+			double d = degree[id];
+			double expected = d > 1 ? 2 * expected_nodes[id] / (d * (d - 1)) : 0;
+			assert(fabs(coefficients[u] - expected) < 1e-12);
+		}
+	}
+	assert(count_triangles(g) == expected_total);
+
+	/* A clique in one direction only, and a node hanging off it */
+	auto clique = create_graph<int, int, int, GraphAM>();
+	add_nodes(clique, vector<NodeSP<int, int>>(nodes.begin(), nodes.begin() + 13));
+	for(int u = 0; u < 12; u++){
+		for(int v = u + 1; v < 12; v++){
+			add_edge(clique, nodes[u], 1, nodes[v]);
+		}
+	}
+	add_edge(clique, nodes[12], 1, nodes[0]);
+	assert(count_triangles(clique) == 220);
+	for(auto& entry : clustering_coefficients(clique)){
+		int id = entry.first->get_id();
+		if(id == 12)
+			assert(entry.second == 0);
+		else if(id == 0)
+			assert(fabs(entry.second - 55.0 / 66) < 1e-12);
+		else
+			assert(fabs(entry.second - 1) < 1e-12);
+	}
+
+	cout << "triangles: OK\n";
+	return 0;
+}
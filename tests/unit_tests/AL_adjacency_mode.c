@@ -0,0 +1,59 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+
+#include "../../src/gcore.h"
+
+
+int main(){
+
+	auto g = create_graph<int, int, int, GraphAL>();
+	g->set_adjacency_mode(AdjacencyMode::sorted, 16);
+
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < 200; ++i){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+		add_node(g, nodes.back());
+	}
+
+	/* Node 0 becomes a hub, node 1 stays below the threshold. Add in reverse to exercise sorting */
+	for(int i = 199; i > 0; --i){
+		add_edge(g, nodes[0], i, nodes[i]);
+	}
+	for(int i = 10; i > 1; --i){
+		add_edge(g, nodes[1], i, nodes[i]);
+	}
+
+	/* Small lists are kept sorted */
+	auto n = neighbours(g, nodes[1]);
+	for(size_t i = 0; i < n.size(); ++i){
+		assert(n[i]->get_id() == (int) i + 2);
+	}
+
+	/* Remove every third edge of the hub and check the rest */
+	for(int i = 3; i < 200; i += 3){
+		remove_edge(g, nodes[0], nodes[i]);
+	}
+	for(int i = 1; i < 200; ++i){
+		assert(adjacent(g, nodes[0], nodes[i]) == (i % 3 != 0));
+		if(i % 3 != 0)
+			assert(get_edge(g, nodes[0], nodes[i])->get_weight() == i);
+	}
+
+	try{
+		add_edge(g, nodes[0], 1, nodes[5]);
+		assert(false && "duplicate edge accepted");
+	}catch(std::invalid_argument&){}
+
+	/* Removing a node drops it from the indexed and the sorted lists */
+	remove_node(g, nodes[5]);
+	assert(neighbours(g, nodes[0]).size() == 132);
+	assert(neighbours(g, nodes[1]).size() == 8);
+
+	/* Switching back keeps the edges */
+	g->set_adjacency_mode(AdjacencyMode::linear);
+	assert(has_edge(g, nodes[0], 7, nodes[7]) && !adjacent(g, nodes[0], nodes[6]));
+
+	cout << "AL_adjacency_mode: OK\n";
+	return 0;
+}
@@ -0,0 +1,61 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+
+#include "../../src/gcore.h"
+
+
+int main(){
+
+	auto g = create_graph<string, int, int, GraphAL>();
+
+	auto n1 = create_node<string, int>("A", nullptr);
+	auto n2 = create_node<string, int>("B", nullptr);
+	auto n3 = create_node<string, int>("C", nullptr);
+	auto n4 = create_node<string, int>("D", nullptr);
+
+	add_nodes(g, {n1, n2, n3, n4});
+	add_edge(g, n1, 1, n3);
+
+	/* Turning tracking on picks up the edges that are already there */
+	g->track_in_edges();
+	add_edge(g, n2, 2, n3);
+	add_edge(g, n4, 4, n3);
+	add_edge(g, n3, 5, n3);
+	add_edge(g, n3, 6, n1);
+
+	auto p = predecessors(g, n3);
+	assert(p.size() == 4);
+	int weight_sum = 0;
+	for(auto edge : in_edges(g, n3)){
+		assert(adjacent(g, edge.first, n3));
+		weight_sum += edge.second;
+	}
+	assert(weight_sum == 12);
+
+	remove_edge(g, n2, n3);
+	assert(predecessors(g, n3).size() == 3);
+
+	/* Removing C drops its in and out edges, self loop included */
+	remove_node(g, n3);
+	assert(neighbours(g, n1).empty() && neighbours(g, n4).empty());
+	assert(predecessors(g, n1).empty());
+	assert(get_edges(g).empty());
+
+	/* Consecutive matches in one list must all go when tracking is off */
+	g->track_in_edges(false);
+	add_node(g, n3);
+	add_edge(g, n1, 1, n2);
+	add_edge(g, n1, 1, n3);
+	add_edge(g, n4, 1, n3);
+	remove_node(g, n3);
+	assert(neighbours(g, n1).size() == 1 && neighbours(g, n4).empty());
+
+	try{
+		predecessors(g, n1);
+		assert(false && "in-edges answered without tracking");
+	}catch(std::logic_error&){}
+
+	cout << "AL_in_edges: OK\n";
+	return 0;
+}
@@ -0,0 +1,43 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+
+#include "../../src/gcore.h"
+
+
+int main(){
+
+	auto g = create_graph<int, bool, int, GraphAM>();
+
+	/* Enough nodes to spill every row over several words */
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < 150; ++i){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+		add_node(g, nodes.back());
+	}
+
+	add_edge(g, nodes[0], true, nodes[1]);
+	add_edge(g, nodes[0], true, nodes[64]);
+	add_edge(g, nodes[0], true, nodes[149]);
+	add_edge(g, nodes[70], true, nodes[0]);
+	add_edge(g, nodes[149], true, nodes[64]);
+
+	assert(adjacent(g, nodes[0], nodes[64]) && !adjacent(g, nodes[64], nodes[0]));
+	assert(has_edge(g, nodes[0], true, nodes[149]));
+
+	auto n = neighbours(g, nodes[0]);
+	assert(n.size() == 3 && n[0] == nodes[1] && n[1] == nodes[64] && n[2] == nodes[149]);
+	assert(edges_of_node(g, nodes[149]).size() == 1);
+	assert(get_edges(g).size() == 5);
+
+	/* Removing node 64 must clear its column in every row */
+	remove_node(g, nodes[64]);
+	assert(neighbours(g, nodes[0]).size() == 2);
+	assert(neighbours(g, nodes[149]).empty());
+
+	remove_edge(g, nodes[70], nodes[0]);
+	assert(!adjacent(g, nodes[70], nodes[0]));
+
+	cout << "AM_unweighted: OK\n";
+	return 0;
+}
@@ -0,0 +1,63 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+int main(){
+
+	auto g = create_graph<string, int, int, GraphAL>();
+	auto m = create_graph<string, int, int, GraphAM>();
+
+	auto n1 = create_node<string, int>("A", nullptr);
+	auto n2 = create_node<string, int>("B", nullptr);
+	auto n3 = create_node<string, int>("C", nullptr);
+	auto n4 = create_node<string, int>("D", nullptr);
+	auto gone = create_node<string, int>("E", nullptr);
+
+	auto e1 = create_edge<string, int, int>(n1, 1, n2);
+	auto e2 = create_edge<string, int, int>(n1, 3, n3);
+	auto e3 = create_edge<string, int, int>(n2, 10, n4);
+	auto e4 = create_edge<string, int, int>(n4, 5, n3);
+
+	/* Leave a hole in the internal ids of both graphs */
+	add_nodes(g, {n1, gone, n2, n3, n4});
+	add_nodes(m, {n1, gone, n2, n3, n4});
+	remove_node(g, gone);
+	remove_node(m, gone);
+
+	add_edges(g, {e1, e2, e3, e4});
+	add_edges(m, {e1, e2, e3, e4});
+
+	auto csr_al = freeze_graph(g);
+	auto csr_am = freeze_graph(m);
+
+	for(auto csr : {csr_al, csr_am}){
+		assert(csr->num_nodes() == 4 && csr->num_edges() == 4);
+		assert(has_node(csr, n3) && !has_node(csr, gone));
+		assert(has_edge(csr, e3) && !has_edge(csr, n2, 9, n4));
+		assert(adjacent(csr, n1, n3) && !adjacent(csr, n3, n1));
+		assert(get_edge(csr, n4, n3) == e4);
+		assert(neighbours(csr, n1).size() == 2);
+		assert(edges_of_node(csr, n3).empty());
+		assert(get_edges(csr).size() == 4);
+		assert(csr->node_at(csr->index_of(n2)) == n2);
+	}
+
+	/* In-edges only when asked for */
+	auto csr_in = freeze_graph(g, true);
+	assert(csr_in->has_in_edges() && !csr_al->has_in_edges());
+	assert(predecessors(csr_in, n3).size() == 2 && predecessors(csr_in, n1).empty());
+	for(auto edge : in_edges(csr_in, n4)){
+		assert(edge.first == n2 && edge.second == 10);
+	}
+
+	/* The traversals run on the snapshot and build their trees as GraphAL */
+	assert((bfs(csr_al, n1) == bfs(g, n1)) && "bfs on the snapshot differs");
+	assert((dfs(csr_am, n1) == dfs(g, n1)) && "dfs on the snapshot differs");
+
+	cout << "CSR_freeze: OK\n";
+	return 0;
+}
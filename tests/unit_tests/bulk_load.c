@@ -0,0 +1,134 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdexcept>
+
+#include "../../src/gcore.h"
+
+
+template <template <typename, typename, typename> typename GraphType>
+void test_bulk_load(){
+
+	auto g = create_graph<int, int, int, GraphType>();
+
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < 100; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+	assert(get_nodes(g).size() == 100);
+
+	/* A repeated node, in the graph or in the batch, rejects the whole batch */
+	bool thrown = false;
+	try{
+		add_nodes(g, {create_node<int, int>(100, nullptr), nodes[3]});
+	}catch(const std::invalid_argument& e){
+		thrown = true;
+	}
+	assert(thrown && !has_node(g, create_node<int, int>(100, nullptr)));
+
+	/* Every node points to the next five, given in reverse and with repeated records */
+	vector<EdgeRecord<int, int>> records;
+	for(int i = 99; i >= 0; i--){
+		for(int k = 5; k >= 1; k--){
+			records.push_back({i, i + k, (i + k) % 100});
+		}
+	}
+	records.push_back({0, 1, 1});
+	add_edges(g, records);
+	assert(get_edges(g).size() == 500);
+	assert(has_edge(g, nodes[98], 101, nodes[1]));
+	assert(neighbours(g, nodes[42]).size() == 5);
+
+	/* A bad record anywhere in the batch leaves the graph as it was */
+	thrown = false;
+	try{
+		add_edges(g, vector<EdgeRecord<int, int>>{{7, 1, 50}, {7, 2, 8}});
+	}catch(const std::invalid_argument& e){
+		thrown = true;
+	}
+	assert(thrown && !adjacent(g, nodes[7], nodes[50]));
+
+	thrown = false;
+	try{
+		add_edges(g, vector<EdgeRecord<int, int>>{{7, 1, 50}, {7, 2, 50}});
+	}catch(const std::invalid_argument& e){
+		thrown = true;
+	}
+	assert(thrown && !adjacent(g, nodes[7], nodes[50]));
+
+	thrown = false;
+	try{
+		add_edges(g, vector<EdgeRecord<int, int>>{{7, 1, 50}, {7, 1, 1000}});
+	}catch(const std::invalid_argument& e){
+		thrown = true;
+	}
+	assert(thrown && !adjacent(g, nodes[7], nodes[50]));
+
+	/* The Edge based helper goes through the same path */
+	add_edges(g, {create_edge<int, int, int>(nodes[7], 1, nodes[50])});
+	assert(get_edge(g, nodes[7], nodes[50])->get_weight() == 1);
+
+	/* but, like add_edge, refuses an Edge repeated with the same weight */
+	thrown = false;
+	try{
+		add_edges(g, {create_edge<int, int, int>(nodes[7], 1, nodes[60]), create_edge<int, int, int>(nodes[7], 1, nodes[60])});
+	}catch(const std::invalid_argument& e){
+		thrown = true;
+	}
+	assert(thrown && !adjacent(g, nodes[7], nodes[60]));
+
+	/* Copies are loaded in bulk too */
+	auto g_copy = copy_graph(g);
+	assert(g_copy == g);
+}
+
+
+int main(){
+
+	test_bulk_load<GraphAL>();
+	test_bulk_load<GraphAM>();
+
+	/* Bulk loading keeps the sorted lists, hub indices and in-edges of GraphAL up to date */
+	auto g = create_graph<int, int, int, GraphAL>();
+	g->set_adjacency_mode(AdjacencyMode::sorted, 8);
+	g->track_in_edges();
+
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < 20; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+	add_edge(g, nodes[0], 1, nodes[10]);
+
+	vector<EdgeRecord<int, int>> records;
+	for(int i = 19; i > 0; i--){
+		if(i != 10) records.push_back({0, i, i});
+		records.push_back({i, 1, 0});
+	}
+	add_edges(g, records);
+
+	assert(neighbours(g, nodes[0]).size() == 19);
+	for(int i = 1; i < 20; i++){
+		assert(get_edge(g, nodes[0], nodes[i])->get_weight() == (i == 10 ? 1 : i));
+	}
+	assert(predecessors(g, nodes[0]).size() == 19);
+	assert(predecessors(g, nodes[10]).size() == 1);
+
+	remove_edge(g, nodes[0], nodes[5]);
+	assert(!adjacent(g, nodes[0], nodes[5]) && adjacent(g, nodes[0], nodes[6]));
+	remove_node(g, nodes[0]);
+	assert(get_edges(g).empty());
+
+	/* In linear mode the new edges keep the order of the batch */
+	auto linear = create_graph<int, int, int, GraphAL>();
+	linear->track_in_edges();
+	add_nodes(linear, {nodes[0], nodes[1], nodes[2], nodes[3], nodes[4]});
+	add_edge(linear, nodes[0], 1, nodes[3]);
+	add_edges(linear, vector<EdgeRecord<int, int>>{{0, 1, 4}, {1, 1, 2}, {0, 1, 2}, {4, 1, 2}, {0, 1, 1}});
+	assert((neighbours(linear, nodes[0]) == vector<NodeSP<int, int>>({nodes[3], nodes[4], nodes[2], nodes[1]})));
+	assert((predecessors(linear, nodes[2]) == vector<NodeSP<int, int>>({nodes[1], nodes[0], nodes[4]})));
+
+	cout << "bulk_load: OK\n";
+	return 0;
+}
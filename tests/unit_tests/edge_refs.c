@@ -0,0 +1,92 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdexcept>
+#include <type_traits>
+#include <unistd.h>
+
+#include "../../src/snapshot.h"
+
+
+static_assert(is_trivially_copyable<EdgeRef<string, int, int>>::value, "EdgeRef must be trivially copyable");
+
+/* The refs read like the Edges of get_edges and edges_of_node, in the same order */
+template <typename I, typename W, typename D, template <typename, typename, typename> typename GraphType>
+void check_refs(GraphSP<I, W, D, GraphType> g){
+
+	auto edges = get_edges(g);
+	auto refs = edge_refs(g);
+	assert(refs.size() == edges.size());
+	for(size_t i = 0; i < refs.size(); i++){
+		assert(refs[i].to_edge() == edges[i]);
+		assert(refs[i].get_src() == edges[i]->get_src() && refs[i].get_dst() == edges[i]->get_dst());
+		assert(refs[i].get_weight() == edges[i]->get_weight());
+	}
+
+	for(auto x : get_nodes(g)){
+
+		/* Looked up by a Node with the same id, the refs still point at the Nodes of the graph */
+		auto lookup = create_node<I, D>(x->get_id(), nullptr);
+		auto expected = edges_of_node(g, x);
+		auto of_node = edge_refs_of_node(g, lookup);
+		assert(of_node.size() == expected.size());
+		for(size_t i = 0; i < of_node.size(); i++){
+			assert(of_node[i].get_src().get() == x.get());
+			assert(of_node[i].to_edge() == expected[i]);
+		}
+	}
+}
+
+
+int main(){
+
+	auto g = create_graph<string, int, int, GraphAL>();
+	auto m = create_graph<string, int, int, GraphAM>();
+
+	auto n1 = create_node<string, int>("A", nullptr);
+	auto n2 = create_node<string, int>("B", nullptr);
+	auto n3 = create_node<string, int>("C", nullptr);
+	auto n4 = create_node<string, int>("D", nullptr);
+	auto gone = create_node<string, int>("E", nullptr);
+
+	add_nodes(g, {n1, gone, n2, n3, n4});
+	add_nodes(m, {n1, gone, n2, n3, n4});
+	remove_node(g, gone);
+	remove_node(m, gone);
+
+	for(auto e : {create_edge<string, int, int>(n1, 1, n2), create_edge<string, int, int>(n1, 3, n3),
+		create_edge<string, int, int>(n1, 7, n4), create_edge<string, int, int>(n4, 5, n3),
+		create_edge<string, int, int>(n3, 2, n3)}){
+		add_edge(g, e);
+		add_edge(m, e);
+	}
+
+	/* Making the refs touches no reference count */
+	long count = n1.use_count();
+	{
+		auto refs = edge_refs(g);
+		auto more = edge_refs(m);
+		assert(n1.use_count() == count);
+	}
+
+	check_refs<string, int, int, GraphAL>(g);
+	check_refs<string, int, int, GraphAM>(m);
+	check_refs<string, int, int, GraphCSR>(freeze_graph(g));
+
+	string path = "/tmp/gcore_" + to_string(getpid()) + "_refs.snap";
+	save_snapshot(g, path);
+	check_refs<string, int, int, GraphSnapshot>(load_snapshot<string, int, int>(path));
+	unlink(path.c_str());
+
+	assert(edge_refs_of_node(g, n2).empty());
+	bool refused = false;
+	try{
+		edge_refs_of_node(m, gone);
+	}catch(const std::invalid_argument& e){
+		refused = true;
+	}
+	assert(refused);
+
+	cout << "edge_refs: OK\n";
+	return 0;
+}
@@ -0,0 +1,46 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "../../src/gcore.h"
+
+
+int main(){
+
+	/* Churn the map with clustered keys and check it against std::map */
+	FlatHashMap<int, int> flat;
+	map<int, int> reference;
+
+	srand(11);
+	for(int k = 0; k < 20000; ++k){
+		int key = (rand() % 3000) * 1024;
+		if(rand() % 3 == 0){
+			assert(flat.erase(key) == reference.erase(key));
+		}else{
+			flat[key] = k;
+			reference[key] = k;
+		}
+	}
+
+	assert(flat.size() == reference.size());
+	for(int key = 0; key < 3000 * 1024; key += 1024){
+		auto value_p = flat.find(key);
+		auto it = reference.find(key);
+		if(it == reference.end()){
+			assert(value_p == nullptr);
+		}else{
+			assert(value_p != nullptr && *value_p == it->second);
+		}
+	}
+
+	/* String ids go through the default id_hash */
+	FlatHashMap<string, int> names;
+	names["A"] = 1;
+	names["B"] = 2;
+	names.erase("A");
+	assert(names.find("A") == nullptr && *names.find("B") == 2);
+
+	cout << "flat_hash_map: OK\n";
+	return 0;
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <assert.h>
+
+#include "../../src/gcore.h"
+
+
+int main(){
+
+	/* A GraphAL in sorted mode, with hubs, tracked in-edges and holes in its internal ids */
+	auto g = create_graph<int, int, int, GraphAL>();
+	g->set_adjacency_mode(AdjacencyMode::sorted, 3);
+	g->track_in_edges();
+
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < 40; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+	for(int i = 0; i < 40; i++){
+		for(int j = 1; j <= i % 6; j++){
+			add_edge(g, nodes[i], i + j, nodes[(i * 7 + j) % 40]);
+		}
+	}
+	remove_node(g, nodes[5]);
+	remove_node(g, nodes[17]);
+
+	auto c = copy_graph<int, int, int, GraphAL>(g);
+	assert(c.get() != g.get());
+	assert((c == g) && "clone differs from the graph");
+	assert(fingerprint(c) == fingerprint(g));
+	assert(c->tracks_in_edges());
+	assert(has_edge(c, nodes[11], 16, nodes[(11 * 7 + 5) % 40]));
+	assert(!has_node(c, nodes[5]) && !has_node(c, nodes[17]));
+	for(int i = 0; i < 40; i++){
+		if(i == 5 || i == 17) continue;
+		assert(predecessors(c, nodes[i]).size() == predecessors(g, nodes[i]).size());
+		assert(neighbours(c, nodes[i]) == neighbours(g, nodes[i]));
+	}
+
+	/* The clone is on its own: changing it leaves the graph alone */
+	auto before = fingerprint(g);
+	remove_edge(c, nodes[11], nodes[(11 * 7 + 5) % 40]);
+	remove_node(c, nodes[3]);
+	add_node(c, nodes[5]);
+	add_node(c, create_node<int, int>(100, nullptr));
+	add_edge(c, nodes[5], 1, nodes[0]);
+	assert(has_edge(g, nodes[11], 16, nodes[(11 * 7 + 5) % 40]));
+	assert(has_node(g, nodes[3]) && !has_node(g, nodes[5]));
+	assert(fingerprint(g) == before && fingerprint(c) != before);
+	assert(predecessors(c, nodes[0]).size() == predecessors(g, nodes[0]).size() + 1);
+	assert(!(c == g));
+
+	/* A weighted GraphAM with a hole */
+	auto m = create_graph<int, long, int, GraphAM>();
+	add_nodes(m, nodes);
+	for(int i = 0; i < 40; i++){
+		add_edge(m, nodes[i], (long) i + 1, nodes[(i * 3) % 40]);
+	}
+	remove_node(m, nodes[9]);
+
+	auto mc = copy_graph<int, long, int, GraphAM>(m);
+	assert((mc == m) && fingerprint(mc) == fingerprint(m));
+	add_edge(mc, nodes[1], 7L, nodes[2]);
+	add_node(mc, nodes[9]);
+	assert(!has_edge(m, nodes[1], 7L, nodes[2]) && !has_node(m, nodes[9]));
+	assert(get_edges(mc).size() == get_edges(m).size() + 1);
+
+	/* An unweighted GraphAM keeps its matrix as bits */
+	auto b = create_graph<int, bool, int, GraphAM>();
+	add_nodes(b, nodes);
+	for(int i = 0; i < 40; i++){
+		add_edge(b, nodes[i], true, nodes[(i * 11) % 40]);
+	}
+	auto bc = copy_graph<int, bool, int, GraphAM>(b);
+	assert(bc == b);
+	remove_edge(bc, nodes[1], nodes[11]);
+	assert(adjacent(b, nodes[1], nodes[11]) && !adjacent(bc, nodes[1], nodes[11]));
+
+	/* Copy-on-write handles share the graph until one of them writes. Only handles count */
+	auto first = copy_on_write(g);
+	auto second = first;
+	assert(first.read().get() == g.get() && second.read().get() == g.get() && first.shared());
+	add_edge(second.write(), nodes[0], 3, nodes[1]);
+	assert(second.read().get() != g.get() && first.read().get() == g.get());
+	assert(!has_edge(first.read(), nodes[0], 3, nodes[1]));
+	assert(has_edge(second.read(), nodes[0], 3, nodes[1]));
+
+	/* Once a handle owns its graph, writes go to it in place, also through a kept pointer */
+	assert(!first.shared() && !second.shared());
+	auto kept = second.write();
+	add_edge(second.write(), nodes[0], 4, nodes[2]);
+	assert(second.read().get() == kept.get());
+	add_edge(kept, nodes[0], 5, nodes[3]);
+	assert(has_edge(second.read(), nodes[0], 5, nodes[3]));
+
+	/* Assigned and destroyed handles are counted too */
+	{
+		auto third = first;
+		assert(first.shared());
+		third = second;
+		assert(!first.shared() && second.shared());
+	}
+	assert(!second.shared());
+
+	cout << "graph_clone: OK\n";
+	return 0;
+}
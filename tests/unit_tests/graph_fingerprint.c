@@ -0,0 +1,151 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "../../src/gcore.h"
+#include "../../src/algo.h"
+
+
+/* The kept fingerprint matches the one walked from a frozen copy */
+template <template <typename, typename, typename> typename GraphType>
+void check_kept(const GraphSP<int, long, int, GraphType>& g){
+	assert(fingerprint(g) == fingerprint(freeze_graph(g)));
+}
+
+
+int main(){
+
+	set_num_threads(4);
+
+	/* The same random changes on adjacency lists in every mode and on a matrix. Nodes come and go
+	with their edges, in both directions */
+	auto linear = create_graph<int, long, int, GraphAL>();
+	auto sorted = create_graph<int, long, int, GraphAL>();
+	auto tracked = create_graph<int, long, int, GraphAL>();
+	auto m = create_graph<int, long, int, GraphAM>();
+	sorted->set_adjacency_mode(AdjacencyMode::sorted, 8);
+	tracked->track_in_edges();
+	assert(fingerprint(linear) == 0);
+
+	int n = 200;
+	vector<NodeSP<int, int>> nodes;
+	vector<bool> present(n, false);
+	for(int i = 0; i < n; i++){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+
+	srand(9);
+	for(int step = 0; step < 6000; step++){
+		int action = rand() % 10;
+		int a = rand() % n, b = rand() % n;
+		long w = rand() % 7 + 1;
+		if(action == 0){
+			if(present[a]){
+				remove_node(linear, nodes[a]);
+				remove_node(sorted, nodes[a]);
+				remove_node(tracked, nodes[a]);
+				remove_node(m, nodes[a]);
+			}else{
+				add_node(linear, nodes[a]);
+				add_node(sorted, nodes[a]);
+				add_node(tracked, nodes[a]);
+				add_node(m, nodes[a]);
+			}
+			present[a] = !present[a];
+		}else if(present[a] && present[b]){
+			if(adjacent(linear, nodes[a], nodes[b])){
+				if(action < 4){
+					remove_edge(linear, nodes[a], nodes[b]);
+					remove_edge(sorted, nodes[a], nodes[b]);
+					remove_edge(tracked, nodes[a], nodes[b]);
+					remove_edge(m, nodes[a], nodes[b]);
+				}
+			}else if(action < 7){
+				add_edge(linear, nodes[a], w, nodes[b]);
+				add_edge(sorted, nodes[a], w, nodes[b]);
+				add_edge(tracked, nodes[a], w, nodes[b]);
+				add_edge(m, nodes[a], w, nodes[b]);
+			}else{
+				vector<EdgeRecord<int, long>> batch = {{a, w, b}, {a, w, b}};
+				add_edges(linear, batch);
+				add_edges(sorted, batch);
+				add_edges(tracked, batch);
+				add_edges(m, batch);
+			}
+		}
+
+		if(step % 100 == 0){
+			check_kept(linear);
+			check_kept(m);
+			assert(fingerprint(sorted) == fingerprint(linear));
+			assert(fingerprint(tracked) == fingerprint(linear));
+			assert(fingerprint(m) == fingerprint(linear));
+		}
+	}
+	check_kept(linear);
+	check_kept(m);
+	assert(linear == sorted && sorted == tracked);
+
+	/* Undoing a change brings the fingerprint back */
+	auto copy = copy_graph(linear);
+	uint64_t before = fingerprint(copy);
+	assert(before == fingerprint(linear) && copy == linear);
+	auto extra = create_node<int, int>(-1, nullptr);
+	add_node(copy, extra);
+	add_edge(copy, extra, 3L, get_nodes(copy)[0]);
+	add_edge(copy, get_nodes(copy)[1], 4L, extra);
+	assert(fingerprint(copy) != before && !(copy == linear));
+	remove_node(copy, extra);
+	assert(fingerprint(copy) == before && copy == linear);
+
+	/* Same edges with another weight, or the other way round, differ */
+	auto g1 = create_graph<int, long, int, GraphAL>();
+	auto g2 = create_graph<int, long, int, GraphAL>();
+	auto g3 = create_graph<int, long, int, GraphAL>();
+	for(auto g : {g1, g2, g3}){
+		add_nodes(g, {nodes[0], nodes[1], nodes[2]});
+	}
+	add_edges(g1, {{0, 1, 1}, {1, 2, 2}});
+	add_edges(g2, {{0, 1, 1}, {1, 3, 2}});
+	add_edges(g3, {{1, 1, 0}, {1, 2, 2}});
+	assert(fingerprint(g1) != fingerprint(g2) && fingerprint(g1) != fingerprint(g3));
+	assert(!(g1 == g2) && !(g1 == g3));
+
+	/* Graphs without a kept fingerprint are compared edge by edge */
+	assert(freeze_graph(g1) == freeze_graph(g1));
+	assert(!(freeze_graph(g1) == freeze_graph(g2)));
+
+	/* Large graphs built in different orders, in linear time */
+	auto big1 = create_graph<int, long, int, GraphAL>();
+	auto big2 = create_graph<int, long, int, GraphAL>();
+	int big = 100000;
+	vector<NodeSP<int, int>> big_nodes;
+	vector<EdgeRecord<int, long>> records;
+	for(int i = 0; i < big; i++){
+		big_nodes.push_back(create_node<int, int>(i, nullptr));
+		for(int k = 1; k <= 4; k++){
+			records.push_back({i, (long) k, (i + k * 7919) % big});
+		}
+	}
+	add_nodes(big1, big_nodes);
+	add_edges(big1, records);
+	reverse(big_nodes.begin(), big_nodes.end());
+	reverse(records.begin(), records.end());
+	add_nodes(big2, big_nodes);
+	for(auto& r : records){
+		add_edge(big2, big_nodes[big - 1 - r.src], r.weight, big_nodes[big - 1 - r.dst]);
+	}
+	assert(big1 == big2 && parallel_equal(big1, big2));
+	remove_edge(big2, big_nodes[0], big_nodes[big - 1 - (big - 1 + 7919) % big]);
+	add_edge(big2, big_nodes[0], 5L, big_nodes[big - 1 - (big - 1 + 7919) % big]);
+	assert(!(big1 == big2) && !parallel_equal(big1, big2));
+
+	/* The threads find a difference that the fingerprints miss */
+	auto csr1 = freeze_graph(big1);
+	auto csr2 = freeze_graph(big2);
+	assert(!parallel_equal(csr1, csr2) && parallel_equal(csr1, freeze_graph(big1)));
+
+	cout << "graph_fingerprint: OK\n";
+	return 0;
+}
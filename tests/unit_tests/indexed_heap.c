@@ -0,0 +1,74 @@
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <assert.h>
+#include <stdlib.h>
+#include <stdexcept>
+
+#include "../../src/heap.h"
+
+using namespace std;
+
+
+template <typename Function>
+bool throws(Function fn){
+	try{
+		fn();
+	}catch(const std::invalid_argument& e){
+		return true;
+	}
+	return false;
+}
+
+
+int main(){
+
+	IndexedHeap<int> heap(10);
+	assert(heap.empty());
+
+	heap.push(3, 30);
+	heap.push(7, 5);
+	heap.push(1, 12);
+	assert(heap.size() == 3 && heap.contains(1) && !heap.contains(2));
+	assert(heap.top() == 7 && heap.top_key() == 5);
+
+	heap.decrease_key(3, 1);
+	assert(heap.top() == 3 && heap.key_of(3) == 1);
+	assert(!heap.push_or_decrease(1, 20) && heap.key_of(1) == 12);
+	assert(heap.push_or_decrease(1, 2) && heap.key_of(1) == 2);
+	assert(heap.push_or_decrease(9, 0) && heap.top() == 9);
+
+	assert(throws([&](){ heap.push(9, 4); }));
+	assert(throws([&](){ heap.decrease_key(2, 4); }));
+	assert(throws([&](){ heap.decrease_key(7, 6); }));
+
+	assert(heap.pop() == 9 && heap.pop() == 3 && heap.pop() == 1 && heap.pop() == 7);
+	assert(heap.empty() && !heap.contains(7));
+
+	/* Random pushes and decreases come out sorted, clear leaves it ready for reuse */
+	srand(5);
+	IndexedHeap<long, 2> binary(1000);
+	for(int round = 0; round < 2; ++round){
+		vector<long> keys(1000);
+		for(int i = 0; i < 1000; ++i){
+			keys[i] = rand() % 5000;
+			binary.push(i, keys[i]);
+		}
+		for(int i = 0; i < 1000; i += 3){
+			keys[i] /= 2;
+			binary.decrease_key(i, keys[i]);
+		}
+		for(int i = 0; i < 400; ++i){
+			int popped = binary.pop();
+			assert(binary.empty() || keys[popped] <= binary.top_key());
+		}
+		binary.clear();
+		assert(binary.empty());
+		for(int i = 0; i < 1000; ++i){
+			assert(!binary.contains(i));
+		}
+	}
+
+	cout << "indexed_heap: OK\n";
+	return 0;
+}
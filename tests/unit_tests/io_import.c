@@ -0,0 +1,107 @@
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <assert.h>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "../../src/io.h"
+
+
+string write_file(const string& name, const string& contents){
+	string path = "/tmp/gcore_" + to_string(getpid()) + "_" + name;
+	ofstream out(path);
+	out << contents;
+	return path;
+}
+
+template <typename Function>
+bool throws(Function fn){
+	try{
+		fn();
+	}catch(const std::invalid_argument& e){
+		return true;
+	}
+	return false;
+}
+
+
+int main(){
+
+	set_num_threads(4);
+
+	/* SNAP, big enough to be parsed in several chunks. Node i points to i + 1 and i + 7 */
+	string snap = "# Directed graph\n# FromNodeId\tToNodeId\n";
+	for(int i = 0; i < 200000; i++){
+		snap += to_string(i) + "\t" + to_string((i + 1) % 200000) + "\n";
+		snap += to_string(i) + " " + to_string((i + 7) % 200000) + "\r\n";
+	}
+	snap += "5\t6";
+	auto snap_path = write_file("snap.txt", snap);
+
+	auto list = read_snap<int, int>(snap_path);
+	assert(list.nodes.size() == 200000 && list.edges.size() == 400001);
+	assert(list.nodes.front() == 0 && list.nodes.back() == 199999);
+	assert(list.edges[2].src == 1 && list.edges[2].dst == 2 && list.edges[2].weight == 1);
+
+	auto g = create_graph<int, int, int, GraphAL>();
+	load_snap(g, snap_path);
+	assert(get_nodes(g).size() == 200000);
+	assert(get_edges(g).size() == 400000);
+	auto n5 = create_node<int, int>(5, nullptr);
+	assert(neighbours(g, n5).size() == 2);
+	assert(adjacent(g, n5, create_node<int, int>(12, nullptr)));
+
+	/* Matrix Market, symmetric with a diagonal entry. Integer weights truncate real entries */
+	auto mm_path = write_file("matrix.mtx",
+		"%%MatrixMarket matrix coordinate real symmetric\n"
+		"% a comment\n"
+		"4 4 3\n"
+		"1 2 2.5\n"
+		"3 1 4\n"
+		"4 4 1e1\n");
+
+	auto g_mm = create_graph<int, int, int, GraphAM>();
+	load_matrix_market(g_mm, mm_path);
+	assert(get_nodes(g_mm).size() == 4);
+	assert(get_edges(g_mm).size() == 5);
+	auto m1 = create_node<int, int>(1, nullptr);
+	auto m2 = create_node<int, int>(2, nullptr);
+	auto m4 = create_node<int, int>(4, nullptr);
+	assert(get_edge(g_mm, m1, m2)->get_weight() == 2);
+	assert(get_edge(g_mm, m2, m1)->get_weight() == 2);
+	assert(get_edge(g_mm, m4, m4)->get_weight() == 10);
+
+	auto truncated_path = write_file("truncated.mtx",
+		"%%MatrixMarket matrix coordinate pattern general\n"
+		"3 3 3\n"
+		"1 2\n"
+		"2 3\n");
+	assert(throws([&](){ read_matrix_market<int, int>(truncated_path); }));
+
+	/* DIMACS, with an isolated node */
+	auto dimacs_path = write_file("graph.gr",
+		"c 9th DIMACS Implementation Challenge\n"
+		"p sp 5 3\n"
+		"c arcs\n"
+		"a 1 2 7\n"
+		"a 2 3 9\n"
+		"a 3 1 14\n");
+
+	auto g_gr = create_graph<long, int, int, GraphAL>();
+	load_dimacs(g_gr, dimacs_path);
+	assert(get_nodes(g_gr).size() == 5);
+	assert(get_edges(g_gr).size() == 3);
+	assert(has_edge(g_gr, create_node<long, int>(3, nullptr), 14, create_node<long, int>(1, nullptr)));
+
+	auto bad_path = write_file("bad.gr", "p sp 2 1\na 1 x 3\n");
+	assert(throws([&](){ read_dimacs<int, int>(bad_path); }));
+	assert(throws([&](){ read_snap<int, int>("/nonexistent/graph.txt"); }));
+
+	for(auto path : {snap_path, mm_path, truncated_path, dimacs_path, bad_path}){
+		unlink(path.c_str());
+	}
+
+	cout << "io_import: OK\n";
+	return 0;
+}
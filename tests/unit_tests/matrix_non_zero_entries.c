@@ -0,0 +1,49 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "../../src/gcore.h"
+
+
+/* Fills the matrix at random and checks the row scan against a plain walk of every row */
+template <typename EntryType>
+void check_scan(){
+
+	SquareMatrix<EntryType> m;
+	for(int i = 0; i < 70; ++i){
+		m.inc_used();
+		if(m.full())
+			m.resize();
+	}
+
+	srand(7);
+	for(int k = 0; k < 600; ++k){
+		m.set_entry(rand() % m.used, rand() % m.used, (EntryType) (1 + rand() % 5));
+	}
+	m.zero_row(3);
+	m.zero_column(17);
+	m.zero_entry(5, 5);
+	m.set_entry(6, 69, 0);
+
+	for(int row = 0; row < m.used; ++row){
+		vector<int> expected;
+		for(int column = 0; column < m.alloced; ++column){
+			if(m.get_entry(row, column) != 0)
+				expected.push_back(column);
+		}
+		assert(m.non_zero_entries(row) == expected);
+		assert(m.non_zero_count(row) == (int) expected.size());
+	}
+}
+
+int main(){
+
+	check_scan<char>();
+	check_scan<short>();
+	check_scan<int>();
+	check_scan<long long>();
+
+	cout << "matrix_non_zero_entries: OK\n";
+	return 0;
+}
@@ -0,0 +1,61 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+
+#include "../../src/gcore.h"
+
+
+/* Walks the views of every node and checks them against neighbours and edges_of_node */
+template <template <typename, typename, typename> typename GraphType>
+void check_views(GraphSP<string, int, int, GraphType> g){
+
+	for(auto x : get_nodes(g)){
+		auto expected_nodes = neighbours(g, x);
+		auto expected_edges = edges_of_node(g, x);
+
+		size_t i = 0;
+		for(auto& y : neighbours_view(g, x)){
+			assert(i < expected_nodes.size() && y == expected_nodes[i]);
+			++i;
+		}
+		assert(i == expected_nodes.size());
+
+		i = 0;
+		for(auto edge : out_edges(g, x)){
+			assert(i < expected_edges.size());
+			assert(edge.first == expected_edges[i]->get_dst());
+			assert(edge.second == expected_edges[i]->get_weight());
+			++i;
+		}
+		assert(i == expected_edges.size());
+	}
+}
+
+int main(){
+
+	auto g = create_graph<string, int, int, GraphAL>();
+	auto m = create_graph<string, int, int, GraphAM>();
+
+	auto n1 = create_node<string, int>("A", nullptr);
+	auto n2 = create_node<string, int>("B", nullptr);
+	auto n3 = create_node<string, int>("C", nullptr);
+	auto n4 = create_node<string, int>("D", nullptr);
+
+	add_nodes(g, {n1, n2, n3, n4});
+	add_nodes(m, {n1, n2, n3, n4});
+
+	for(auto e : {create_edge<string, int, int>(n1, 1, n2), create_edge<string, int, int>(n1, 3, n3),
+		create_edge<string, int, int>(n1, 7, n4), create_edge<string, int, int>(n4, 5, n3)}){
+		add_edge(g, e);
+		add_edge(m, e);
+	}
+
+	check_views<GraphAL>(g);
+	check_views<GraphAM>(m);
+	check_views<GraphCSR>(freeze_graph(g));
+
+	assert(neighbours_view(g, n2).empty() && neighbours_view(m, n3).empty());
+
+	cout << "neighbour_views: OK\n";
+	return 0;
+}
@@ -0,0 +1,82 @@
+#include <string>
+#include <iostream>
+#include <assert.h>
+
+#include "../../src/gcore.h"
+#include "../../src/SlabArray.h"
+
+
+/* Counts the live objects, to check that slots are constructed and destroyed once */
+struct Counted{
+	static int live;
+	string name;
+
+	Counted(const string& name) : name(name) {
+		++live;
+	}
+
+	~Counted(){
+		--live;
+	}
+};
+int Counted::live = 0;
+
+
+int main(){
+
+	{
+		SlabArray<Counted, 3> slabs;
+		vector<Counted *> objects;
+		for(int i = 0; i < 50; ++i){
+			objects.push_back(slabs.emplace(i, to_string(i)));
+		}
+		assert(Counted::live == 50);
+
+		/* Neighbouring slots of a slab are neighbours in memory, and nothing moves when the
+		array grows */
+		assert(objects[9] + 1 == objects[10]);
+		assert((uintptr_t) objects[0] % 64 == 0 && (uintptr_t) objects[8] % 64 == 0);
+		slabs.reserve(5000);
+		for(int i = 0; i < 50; ++i){
+			assert(&slabs[i] == objects[i] && slabs[i].name == to_string(i));
+		}
+
+		/* A destroyed slot takes a new object at the same address */
+		slabs.destroy(17);
+		assert(Counted::live == 49);
+		assert(slabs.emplace(17, "again") == objects[17]);
+		assert(slabs[17].name == "again");
+
+		for(int i = 0; i < 50; ++i){
+			slabs.destroy(i);
+		}
+		assert(Counted::live == 0);
+	}
+
+	/* A wrapper of GraphAL takes one cache line, whether in-edges are tracked or not */
+	assert(sizeof(NodeAL<int, int, int>) == 64 && sizeof(NodeAL<string, long, int>) == 64);
+
+	/* Graphs keep their wrappers in slabs: removed nodes give their slot to the next ones */
+	auto g = create_graph<int, int, int, GraphAL>();
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < 1000; ++i){
+		nodes.push_back(create_node<int, int>(i, nullptr));
+	}
+	add_nodes(g, nodes);
+	for(int i = 0; i < 999; ++i){
+		add_edge(g, nodes[i], i, nodes[i + 1]);
+	}
+	for(int i = 0; i < 1000; i += 2){
+		remove_node(g, nodes[i]);
+	}
+	for(int i = 0; i < 1000; i += 2){
+		add_node(g, nodes[i]);
+	}
+	assert(get_nodes(g).size() == 1000 && get_edges(g).size() == 0);
+	long count = nodes[0].use_count();
+	g.reset();
+	assert(nodes[0].use_count() == count - 1);
+
+	cout << "slab_array: OK\n";
+	return 0;
+}
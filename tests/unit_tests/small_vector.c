@@ -0,0 +1,86 @@
+#include <string>
+#include <vector>
+#include <iostream>
+#include <assert.h>
+#include <stdlib.h>
+
+#include "../../src/gcore.h"
+#include "../../src/SmallVector.h"
+
+
+template <typename T, unsigned N>
+bool same(const SmallVector<T, N>& small, const vector<T>& reference){
+	return small.size() == reference.size() && equal(small.begin(), small.end(), reference.begin());
+}
+
+
+int main(){
+
+	/* Inserts and erases anywhere, across the move from inline to the heap, against std::vector */
+	SmallVector<pair<int, long>, 4> small;
+	vector<pair<int, long>> reference;
+	assert(small.empty() && small.is_inline());
+
+	srand(5);
+	for(int k = 0; k < 5000; ++k){
+		int action = rand() % 4;
+		if(action == 0 && !reference.empty()){
+			size_t i = rand() % reference.size();
+			small.erase(small.begin() + i);
+			reference.erase(reference.begin() + i);
+		}else if(action == 1){
+			size_t i = reference.empty() ? 0 : rand() % (reference.size() + 1);
+			small.insert(small.begin() + i, make_pair(k, (long) -k));
+			reference.insert(reference.begin() + i, make_pair(k, (long) -k));
+		}else{
+			small.push_back(make_pair(k, (long) k));
+			reference.push_back(make_pair(k, (long) k));
+		}
+		assert(same(small, reference));
+	}
+	assert(!small.is_inline());
+
+	/* Elements that own memory are copied, moved and destroyed properly, inline or not */
+	for(size_t n : {3, 4, 40}){
+		SmallVector<string, 4> strings;
+		vector<string> expected;
+		for(size_t i = 0; i < n; ++i){
+			strings.push_back(string(30, 'a' + i % 26));
+			expected.push_back(string(30, 'a' + i % 26));
+		}
+		assert(strings.is_inline() == (n <= 4));
+
+		SmallVector<string, 4> copy(strings);
+		assert(same(copy, expected) && same(strings, expected));
+		SmallVector<string, 4> moved(std::move(copy));
+		assert(same(moved, expected) && copy.empty());
+
+		SmallVector<string, 4> assigned;
+		assigned.push_back("x");
+		assigned = strings;
+		assert(same(assigned, expected));
+		assigned = std::move(moved);
+		assert(same(assigned, expected) && moved.empty());
+
+		assigned.pop_back();
+		expected.pop_back();
+		assert(same(assigned, expected) && assigned.back() == expected.back());
+		assigned.clear();
+		assert(assigned.empty());
+	}
+
+	/* Reserving goes to the heap once */
+	SmallVector<int, 2> reserved;
+	reserved.reserve(100);
+	auto first = reserved.begin();
+	for(int i = 0; i < 100; ++i){
+		reserved.push_back(i);
+	}
+	assert(reserved.begin() == first && reserved[99] == 99);
+
+	/* The inline elements share the space of the heap pointer */
+	assert(sizeof(SmallVector<pair<int *, int>, 1>) == 24);
+
+	cout << "small_vector: OK\n";
+	return 0;
+}
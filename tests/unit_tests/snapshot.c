@@ -0,0 +1,147 @@
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <assert.h>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "../../src/snapshot.h"
+#include "../../src/algo.h"
+
+
+template <typename Function>
+bool throws(Function fn){
+	try{
+		fn();
+	}catch(const std::invalid_argument& e){
+		return true;
+	}
+	return false;
+}
+
+
+int main(){
+
+	string prefix = "/tmp/gcore_" + to_string(getpid()) + "_";
+
+	/* String ids, written from a GraphAL with a hole in its internal ids */
+	auto g = create_graph<string, int, int, GraphAL>();
+
+	auto n1 = create_node<string, int>("A", nullptr);
+	auto n2 = create_node<string, int>("B", nullptr);
+	auto n3 = create_node<string, int>("C", nullptr);
+	auto n4 = create_node<string, int>("D", nullptr);
+	auto gone = create_node<string, int>("E", nullptr);
+
+	auto e1 = create_edge<string, int, int>(n1, 1, n2);
+	auto e2 = create_edge<string, int, int>(n1, 3, n3);
+	auto e3 = create_edge<string, int, int>(n2, 10, n4);
+	auto e4 = create_edge<string, int, int>(n4, 5, n3);
+
+	add_nodes(g, {n4, gone, n2, n3, n1});
+	remove_node(g, gone);
+	add_edges(g, {e1, e2, e3, e4});
+
+	string path = prefix + "strings.snap";
+	save_snapshot(g, path);
+	auto s = load_snapshot<string, int, int>(path, true);
+
+	assert(s->num_nodes() == 4 && s->num_edges() == 4);
+	assert(has_node(s, n3) && !has_node(s, gone));
+	assert(has_edge(s, e3) && !has_edge(s, n2, 9, n4));
+	assert(adjacent(s, n1, n3) && !adjacent(s, n3, n1));
+	assert(get_edge(s, n4, n3) == e4);
+	assert(neighbours(s, n1).size() == 2);
+	assert(edges_of_node(s, n3).empty());
+	assert(get_edges(s).size() == 4);
+	assert(s->id_at(s->index_of(n2)) == "B");
+	assert(s->find_index("Z") == -1);
+
+	/* The dense indices are the ones of the frozen graph */
+	auto csr = freeze_graph(g);
+	for(int i = 0; i < csr->num_nodes(); ++i){
+		assert(s->node_at(i) == csr->node_at(i));
+	}
+	assert((bfs(s, n1) == bfs(g, n1)) && "bfs on the snapshot differs");
+
+	/* Wrong types are refused */
+	assert(throws([&](){ load_snapshot<int, int, int>(path); }));
+	assert(throws([&](){ load_snapshot<string, long, int>(path); }));
+
+	/* Integer ids, written from a GraphAM */
+	auto m = create_graph<int, long, int, GraphAM>();
+	vector<NodeSP<int, int>> nodes;
+	for(int i = 0; i < 50; i++){
+		nodes.push_back(create_node<int, int>(1000 - 7 * i, nullptr));
+	}
+	add_nodes(m, nodes);
+	vector<EdgeRecord<int, long>> records;
+	for(int i = 0; i < 50; i++){
+		records.push_back({1000 - 7 * i, (long) i + 1, 1000 - 7 * ((i * 3) % 50)});
+	}
+	add_edges(m, records);
+
+	string int_path = prefix + "ints.snap";
+	save_snapshot(m, int_path);
+	auto t = load_snapshot<int, long, int>(int_path);
+	assert(t->verify());
+	assert(t->num_nodes() == 50 && t->num_edges() == 50);
+	for(auto& record : records){
+		int src = t->find_index(record.src);
+		int dst = t->find_index(record.dst);
+		assert(src != -1 && dst != -1);
+		auto first = t->target_array() + t->offset_array()[src];
+		auto last = t->target_array() + t->offset_array()[src + 1];
+		assert(last - first == 1 && *first == dst);
+		assert(t->weight_array()[t->offset_array()[src]] == record.weight);
+	}
+
+	/* A flipped byte in the weights is caught by verify, one in the header on load */
+	{
+		fstream f(int_path, ios::in | ios::out | ios::binary);
+		f.seekp(-3, ios::end);
+		f.put(0x7f);
+	}
+	auto damaged = load_snapshot<int, long, int>(int_path);
+	assert(!damaged->verify());
+	assert(throws([&](){ load_snapshot<int, long, int>(int_path, true); }));
+	{
+		fstream f(int_path, ios::in | ios::out | ios::binary);
+		f.seekp(40, ios::beg);
+		f.put(0x7f);
+	}
+	assert(throws([&](){ load_snapshot<int, long, int>(int_path); }));
+	assert(throws([&](){ load_snapshot<int, long, int>(prefix + "missing.snap"); }));
+
+	/* Unverified loads check the indices and offsets they read from the sections */
+	string bad_path = prefix + "bad.snap";
+	auto damage = [&](int section, size_t position, auto value){
+		save_snapshot(m, bad_path);
+		SnapshotHeader header;
+		fstream f(bad_path, ios::in | ios::out | ios::binary);
+		f.read((char*) &header, sizeof(header));
+		f.seekp(header.sections[section].offset + position * sizeof(value), ios::beg);
+		f.write((const char*) &value, sizeof(value));
+	};
+	damage(SNAPSHOT_OFFSETS, 0, (size_t) 8);
+	assert(throws([&](){ load_snapshot<int, long, int>(bad_path); }));
+	damage(SNAPSHOT_ORDER, 0, 1 << 30);
+	auto bad = load_snapshot<int, long, int>(bad_path);
+	assert(throws([&](){ bad->find_index(1000 - 7 * 49); }));
+	assert(throws([&](){ bad->node_at(-1); }));
+	damage(SNAPSHOT_OFFSETS, 1, (size_t) 1 << 40);
+	bad = load_snapshot<int, long, int>(bad_path);
+	assert(throws([&](){ neighbours(bad, bad->node_at(0)); }));
+	assert(throws([&](){ adjacent(bad, bad->node_at(0), bad->node_at(1)); }));
+	assert(throws([&](){ get_edges(bad); }));
+	damage(SNAPSHOT_TARGETS, 0, -5);
+	bad = load_snapshot<int, long, int>(bad_path);
+	assert(throws([&](){ get_edges(bad); }));
+
+	unlink(path.c_str());
+	unlink(int_path.c_str());
+	unlink(bad_path.c_str());
+
+	cout << "snapshot: OK\n";
+	return 0;
+}